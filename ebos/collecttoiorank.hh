@@ -43,7 +43,14 @@
 
 #include <dune/grid/common/mcmgmapper.hh>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace Ewoms
 {
@@ -93,7 +100,10 @@ namespace Ewoms
             const std::vector<int>& distributedGlobalIndex_;
             IndexMapType& localIndexMap_;
             IndexMapStorageType& indexMaps_;
-            std::map< const int, const int > globalPosition_;
+            // maps Cartesian indices to indices of the global grid. since the
+            // Cartesian indices are bounded by the size of the logically Cartesian
+            // grid, a flat vector is used instead of a search tree.
+            std::vector<int> globalPosition_;
             std::vector<int>& ranks_;
 
         public:
@@ -110,9 +120,16 @@ namespace Ewoms
             {
                 const size_t size = globalIndex.size();
                 // create mapping globalIndex --> localIndex
+                int maxGlobalIndex = -1;
                 for ( size_t index = 0; index < size; ++index )
                 {
-                    globalPosition_.insert( std::make_pair( globalIndex[ index ], index ) );
+                    maxGlobalIndex = std::max( maxGlobalIndex, globalIndex[ index ] );
+                }
+
+                globalPosition_.resize( maxGlobalIndex + 1, -1 );
+                for ( size_t index = 0; index < size; ++index )
+                {
+                    globalPosition_[ globalIndex[ index ] ] = index;
                 }
 
                 // we need to create a mapping from local to global
@@ -164,7 +181,8 @@ namespace Ewoms
                 {
                     int globalId = -1;
                     buffer.read( globalId );
-                    assert( globalPosition_.find( globalId ) != globalPosition_.end() );
+                    assert( 0 <= globalId && globalId < static_cast<int>(globalPosition_.size()) );
+                    assert( globalPosition_[ globalId ] >= 0 );
                     indexMap[ index ] = globalPosition_[ globalId ];
                     ranks_[ indexMap[ index ] ] = link + 1;
                 }
@@ -177,7 +195,10 @@ namespace Ewoms
             typename Vanguard::Grid, typename Vanguard::EquilGrid > :: value ;
 
         CollectDataToIORank( const Vanguard& vanguard )
-            : toIORankComm_( )
+            : toIORankComm_( ),
+              globalData_( std::make_shared<GlobalData>( localIndexMap_, indexMaps_ ) ),
+              sendSize_( 0 ),
+              sendPending_( false )
         {
             // index maps only have to be build when reordering is needed
             if( ! needsReordering && ! isParallel() )
@@ -309,11 +330,20 @@ namespace Ewoms
                         assert(ret.second);
                     }
 
-                    MessageBufferType buffer;
-                    pack( 0, buffer );
+                    // the data of the I/O rank itself does not need to go through
+                    // a message buffer. the last index map is the local one
+                    const IndexMapType& indexMap = indexMaps.back();
+                    for (const auto& pair : localCellData_) {
+                        const auto& localData = pair.second.data;
+                        auto& globalData = globalCellData_.data(pair.first);
 
-                    // the last index map is the local one
-                    doUnpack( indexMaps.back(), buffer );
+                        const size_t size = localIndexMap_.size();
+                        assert( indexMap.size() == size );
+                        for( size_t i=0; i<size; ++i )
+                        {
+                            globalData[ indexMap[ i ] ] = localData[ localIndexMap_[ i ] ];
+                        }
+                    }
                 }
             }
 
@@ -337,10 +367,10 @@ namespace Ewoms
             void doUnpack( const IndexMapType& indexMap, MessageBufferType& buffer )
             {
                 // we loop over the data  as
-                // its order governs the order the data got received.
-                for (auto& pair : localCellData_) {
-                    const std::string& key = pair.first;
-                    auto& data = globalCellData_.data(key);
+                // its order governs the order the data got received. the global cell
+                // data exhibits the same keys as the local one of every rank.
+                for (auto& pair : globalCellData_) {
+                    auto& data = pair.second.data;
 
                     //write all data from local cell data to buffer
                     read( buffer, indexMap, data);
@@ -493,12 +523,164 @@ namespace Ewoms
 
         };
 
-        // gather solution to rank 0 for EclipseWriter
+        // sends the cell, well and block data using a single message per rank, so
+        // that the processes only need to synchronize once per report step
+        class PackUnPackOutputData : public P2PCommunicatorType::DataHandleInterface
+        {
+            PackUnPackCellData& cellData_;
+            PackUnPackWellData& wellData_;
+            PackUnPackBlockData& blockData_;
+
+        public:
+            PackUnPackOutputData( PackUnPackCellData& cellData,
+                                  PackUnPackWellData& wellData,
+                                  PackUnPackBlockData& blockData )
+              : cellData_( cellData ),
+                wellData_( wellData ),
+                blockData_( blockData )
+            {}
+
+            // pack all data associated with link
+            void pack( const int link, MessageBufferType& buffer )
+            {
+                cellData_.pack( link, buffer );
+                wellData_.pack( link, buffer );
+                blockData_.pack( link, buffer );
+            }
+
+            // unpack all data associated with link. the order must be the same as
+            // the one of pack()
+            void unpack( const int link, MessageBufferType& buffer )
+            {
+                cellData_.unpack( link, buffer );
+                wellData_.unpack( link, buffer );
+                blockData_.unpack( link, buffer );
+            }
+        };
+
+        // the output data of a single report step which is gathered on the I/O rank. the
+        // messages of the other ranks are received without blocking, i.e., their data is
+        // only available after finish() has been called. the thread which writes the
+        // data to disk can thus wait for them.
+        class GlobalData
+        {
+            friend class CollectDataToIORank;
+
+        public:
+            GlobalData( const IndexMapType& localIndexMap,
+                        const IndexMapStorageType& indexMaps )
+              : localIndexMap_( localIndexMap ),
+                indexMaps_( indexMaps ),
+                finished_( true )
+            {}
+
+            GlobalData( const GlobalData& ) = delete;
+
+            ~GlobalData()
+            {
+                // the pending messages must be received before the buffers go away.
+                // destructors must not throw, and the data is not used anymore anyway.
+                try {
+                    finish();
+                }
+                catch (...) {
+                }
+            }
+
+            // wait until the data of all ranks has been received and unpack it
+            void finish()
+            {
+                if( finished_ )
+                {
+                    return;
+                }
+                finished_ = true;
+
+#if HAVE_MPI
+                // the size of each message is sent ahead of it
+                const int numLinks = recvRanks_.size();
+                MPI_Waitall( numLinks, sizeRequests_.data(), MPI_STATUSES_IGNORE );
+
+                std::vector<MPI_Request> dataRequests( numLinks );
+                for( int link = 0; link < numLinks; ++link )
+                {
+                    recvBuffers_[ link ].resize( recvSizes_[ link ] );
+                    MPI_Irecv( recvBuffers_[ link ].buffer().first,
+                               static_cast<int>( recvSizes_[ link ] ),
+                               MPI_BYTE,
+                               recvRanks_[ link ],
+                               dataTag,
+                               comm_,
+                               &dataRequests[ link ] );
+                }
+                MPI_Waitall( numLinks, dataRequests.data(), MPI_STATUSES_IGNORE );
+
+                // the data of the I/O rank itself is already contained, so the local
+                // data passed to the handles is not used
+                const Opm::data::Solution noCellData;
+                const Opm::data::Wells noWellData;
+                const std::map<std::pair<std::string, int>, double> noBlockData;
+                PackUnPackCellData
+                    unpackCellData( noCellData, cellData_, localIndexMap_, indexMaps_,
+                                    /*globalSize=*/0, /*isIORank=*/false );
+                PackUnPackWellData
+                    unpackWellData( noWellData, wellData_, /*isIORank=*/false );
+                PackUnPackBlockData
+                    unpackBlockData( noBlockData, blockData_, /*isIORank=*/false );
+                PackUnPackOutputData
+                    unpackOutputData( unpackCellData, unpackWellData, unpackBlockData );
+
+                for( int link = 0; link < numLinks; ++link )
+                {
+                    unpackOutputData.unpack( link, recvBuffers_[ link ] );
+                }
+                recvBuffers_.clear();
+#endif
+            }
+
+            const Opm::data::Solution& cellData() const
+            {
+                return cellData_;
+            }
+
+            const Opm::data::Wells& wellData() const
+            {
+                return wellData_;
+            }
+
+            const std::map<std::pair<std::string, int>, double>& blockData() const
+            {
+                return blockData_;
+            }
+
+        private:
+            const IndexMapType& localIndexMap_;
+            const IndexMapStorageType& indexMaps_;
+
+            Opm::data::Solution cellData_;
+            Opm::data::Wells wellData_;
+            std::map<std::pair<std::string, int>, double> blockData_;
+
+            bool finished_;
+#if HAVE_MPI
+            MPI_Comm comm_;
+            std::vector<int> recvRanks_;
+            std::vector<unsigned long> recvSizes_;
+            std::vector<MPI_Request> sizeRequests_;
+            std::vector<MessageBufferType> recvBuffers_;
+#endif
+        };
+
+        ~CollectDataToIORank()
+        {
+            waitForSend_();
+        }
+
+        // gather solution to rank 0 for EclipseWriter. on the I/O rank, the data of the
+        // other ranks is only complete after GlobalData::finish() has been called.
         void collect( const Opm::data::Solution& localCellData, const std::map<std::pair<std::string, int>, double>& localBlockData, const Opm::data::Wells& localWellData)
         {
-            globalCellData_ = {};
-            globalBlockData_.clear();
-            globalWellData_.clear();
+            globalData_ = std::make_shared<GlobalData>( localIndexMap_, indexMaps_ );
 
             // index maps only have to be build when reordering is needed
             if( ! needsReordering && ! isParallel() )
@@ -509,7 +691,7 @@ namespace Ewoms
             // this also packs and unpacks the local buffers one ioRank
             PackUnPackCellData
                 packUnpackCellData( localCellData,
-                            globalCellData_,
+                            globalData_->cellData_,
                             localIndexMap_,
                             indexMaps_,
                             numCells(),
@@ -523,39 +705,64 @@ namespace Ewoms
 
             PackUnPackWellData
                 packUnpackWellData( localWellData,
-                            globalWellData_,
+                            globalData_->wellData_,
                             isIORank() );
 
             PackUnPackBlockData
                 packUnpackBlockData( localBlockData,
-                            globalBlockData_,
+                            globalData_->blockData_,
                             isIORank() );
 
-            toIORankComm_.exchange( packUnpackCellData );
-            toIORankComm_.exchange( packUnpackWellData );
-            toIORankComm_.exchange( packUnpackBlockData );
-
+            PackUnPackOutputData
+                packUnpackOutputData( packUnpackCellData,
+                                      packUnpackWellData,
+                                      packUnpackBlockData );
 
+            if( isIORank() )
+            {
+                postReceives_( *globalData_ );
+            }
+            else
+            {
+                sendToIORank_( packUnpackOutputData );
+            }
+        }
 
-#ifndef NDEBUG
-            // mkae sure every process is on the same page
-            toIORankComm_.barrier();
-#endif
+        // the data gathered by the last call to collect()
+        const std::shared_ptr<GlobalData>& globalData() const
+        {
+            return globalData_;
         }
 
         const std::map<std::pair<std::string, int>, double>& globalBlockData() const
         {
-            return globalBlockData_;
+            globalData_->finish();
+            return globalData_->blockData();
         }
 
         const Opm::data::Solution& globalCellData() const
         {
-            return globalCellData_;
+            globalData_->finish();
+            return globalData_->cellData();
         }
 
         const Opm::data::Wells& globalWellData() const
         {
-            return globalWellData_;
+            globalData_->finish();
+            return globalData_->wellData();
+        }
+
+        // returns true if GlobalData::finish() may be called by a thread other than the
+        // one which calls collect(), i.e., if MPI may be called concurrently
+        static bool mayFinishOnOtherThread()
+        {
+#if HAVE_MPI
+            int threadLevel = MPI_THREAD_SINGLE;
+            MPI_Query_thread( &threadLevel );
+            return threadLevel == MPI_THREAD_MULTIPLE;
+#else
+            return true;
+#endif
         }
 
         bool isIORank() const
@@ -607,14 +814,90 @@ namespace Ewoms
         }
 
     protected:
+        enum { sizeTag = 9437, dataTag = 9438 };
+
+        // post the receives of the message sizes of all other ranks. the messages
+        // themselves are received by GlobalData::finish()
+        void postReceives_( GlobalData& globalData OPM_UNUSED )
+        {
+#if HAVE_MPI
+            globalData.finished_ = false;
+            globalData.comm_ = toIORankComm_;
+            for( int rank = 0; rank < toIORankComm_.size(); ++rank )
+            {
+                if( rank != ioRank )
+                {
+                    globalData.recvRanks_.push_back( rank );
+                }
+            }
+
+            const int numLinks = globalData.recvRanks_.size();
+            globalData.recvSizes_.resize( numLinks, 0 );
+            globalData.sizeRequests_.resize( numLinks );
+            globalData.recvBuffers_.resize( numLinks );
+            for( int link = 0; link < numLinks; ++link )
+            {
+                MPI_Irecv( &globalData.recvSizes_[ link ],
+                           1,
+                           MPI_UNSIGNED_LONG,
+                           globalData.recvRanks_[ link ],
+                           sizeTag,
+                           globalData.comm_,
+                           &globalData.sizeRequests_[ link ] );
+            }
+#endif
+        }
+
+        // send the packed data to the I/O rank without waiting for its delivery. the
+        // send buffer is kept until the messages have been sent.
+        void sendToIORank_( PackUnPackOutputData& packUnpackOutputData OPM_UNUSED )
+        {
+#if HAVE_MPI
+            // the messages of the previous report step must have been sent before
+            // the buffer can be reused
+            waitForSend_();
+
+            sendBuffer_.clear();
+            packUnpackOutputData.pack( /*link=*/0, sendBuffer_ );
+            sendSize_ = sendBuffer_.size();
+
+            MPI_Comm comm = toIORankComm_;
+            MPI_Isend( &sendSize_, 1, MPI_UNSIGNED_LONG, ioRank, sizeTag, comm, &sendRequests_[ 0 ] );
+            MPI_Isend( sendBuffer_.buffer().first,
+                       static_cast<int>( sendSize_ ),
+                       MPI_BYTE,
+                       ioRank,
+                       dataTag,
+                       comm,
+                       &sendRequests_[ 1 ] );
+            sendPending_ = true;
+#endif
+        }
+
+        void waitForSend_()
+        {
+#if HAVE_MPI
+            if( sendPending_ )
+            {
+                MPI_Waitall( 2, sendRequests_, MPI_STATUSES_IGNORE );
+                sendPending_ = false;
+            }
+#endif
+        }
+
         P2PCommunicatorType             toIORankComm_;
         IndexMapType                    globalCartesianIndex_;
         IndexMapType                    localIndexMap_;
         IndexMapStorageType             indexMaps_;
         std::vector<int>                globalRanks_;
-        Opm::data::Solution             globalCellData_;
-        std::map<std::pair<std::string, int>, double> globalBlockData_;
-        Opm::data::Wells globalWellData_;
+        std::shared_ptr<GlobalData>     globalData_;
+
+        MessageBufferType               sendBuffer_;
+        unsigned long                   sendSize_;
+        bool                            sendPending_;
+#if HAVE_MPI
+        MPI_Request                     sendRequests_[ 2 ];
+#endif
     };
 
 } // end namespace Opm
@@ -37,6 +37,9 @@
 
 #include <dune/common/version.hh>
 
+#include <vector>
+#include <cassert>
+
 namespace Ewoms {
 template <class TypeTag>
 class EclCpGridVanguard;
@@ -150,40 +153,26 @@ public:
             // its edge weights. since this is (kind of) a layering violation and
             // transmissibilities are relatively expensive to compute, we only do it if
             // more than a single process is involved in the simulation.
+            //
+            // at this point, every process still holds the complete grid, i.e.,
+            // computing the transmissibilities on all of them would just repeat the same
+            // work. we thus only compute them on the I/O rank and broadcast the edge
+            // weights to the remaining processes.
             cartesianIndexMapper_ = new CartesianIndexMapper(*grid_);
-            globalTrans_ = new EclTransmissibility<TypeTag>(*this);
-            globalTrans_->update();
 
-            // convert to transmissibility for faces
             // TODO: grid_->numFaces() is not generic. use grid_->size(1) instead? (might
             // not work)
-            const auto& gridView = grid_->leafGridView();
             unsigned numFaces = grid_->numFaces();
             std::vector<double> faceTrans(numFaces, 0.0);
-#if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
-            ElementMapper elemMapper(this->gridView(), Dune::mcmgElementLayout());
-#else
-            ElementMapper elemMapper(this->gridView());
-#endif
-            auto elemIt = gridView.template begin</*codim=*/0>();
-            const auto& elemEndIt = gridView.template end</*codim=*/0>();
-            for (; elemIt != elemEndIt; ++ elemIt) {
-                const auto& elem = *elemIt;
-                auto isIt = gridView.ibegin(elem);
-                const auto& isEndIt = gridView.iend(elem);
-                for (; isIt != isEndIt; ++ isIt) {
-                    const auto& is = *isIt;
-                    if (!is.neighbor())
-                        continue;
-
-                    unsigned I = elemMapper.index(is.inside());
-                    unsigned J = elemMapper.index(is.outside());
-
-                    // FIXME (?): this is not portable!
-                    unsigned faceIdx = is.id();
-
-                    faceTrans[faceIdx] = globalTrans_->transmissibility(I, J);
-                }
+            if (mpiRank == 0)
+                computeFaceTransmissibilities_(faceTrans);
+            MPI_Bcast(faceTrans.data(), static_cast<int>(numFaces), MPI_DOUBLE, /*root=*/0, MPI_COMM_WORLD);
+
+            // the global transmissibilities are only required by the partitioner. If
+            // they are not exported, release them before the grid is distributed.
+            if (!GET_PROP_VALUE(TypeTag, ExportGlobalTransmissibility)) {
+                delete globalTrans_;
+                globalTrans_ = nullptr;
             }
 
             //distribute the grid and switch to the distributed view.
@@ -191,15 +180,11 @@ public:
                 const auto wells = this->schedule().getWells();
                 defunctWellNames_ = std::get<1>(grid_->loadBalance(&wells, faceTrans.data()));
             }
+            std::vector<double>().swap(faceTrans);
             grid_->switchToDistributedView();
 
             delete cartesianIndexMapper_;
             cartesianIndexMapper_ = nullptr;
-
-            if (!GET_PROP_VALUE(TypeTag, ExportGlobalTransmissibility)) {
-                delete globalTrans_;
-                globalTrans_ = nullptr;
-            }
         }
 #endif
 
@@ -224,6 +209,12 @@ public:
     std::unordered_set<std::string> defunctWellNames() const
     { return defunctWellNames_; }
 
+    /*!
+     * \brief Returns the transmissibilities of the global (i.e., non-distributed) grid
+     *
+     * These are only available on the I/O rank of a parallel run and only if the
+     * ExportGlobalTransmissibility property is set.
+     */
     const EclTransmissibility<TypeTag>& globalTransmissibility() const
     { return *globalTrans_; }
 
@@ -258,6 +249,43 @@ protected:
         globalTrans_ = nullptr;
     }
 
+#if HAVE_MPI
+    // compute the transmissibilities of the global grid and convert them to the edge
+    // weights which are expected by the CpGrid's loadBalance() method
+    void computeFaceTransmissibilities_(std::vector<double>& faceTrans)
+    {
+        globalTrans_ = new EclTransmissibility<TypeTag>(*this);
+        globalTrans_->update();
+
+        const auto& gridView = grid_->leafGridView();
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
+        ElementMapper elemMapper(this->gridView(), Dune::mcmgElementLayout());
+#else
+        ElementMapper elemMapper(this->gridView());
+#endif
+        auto elemIt = gridView.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++ elemIt) {
+            const auto& elem = *elemIt;
+            auto isIt = gridView.ibegin(elem);
+            const auto& isEndIt = gridView.iend(elem);
+            for (; isIt != isEndIt; ++ isIt) {
+                const auto& is = *isIt;
+                if (!is.neighbor())
+                    continue;
+
+                unsigned I = elemMapper.index(is.inside());
+                unsigned J = elemMapper.index(is.outside());
+
+                // FIXME (?): this is not portable!
+                unsigned faceIdx = is.id();
+
+                faceTrans[faceIdx] = globalTrans_->transmissibility(I, J);
+            }
+        }
+    }
+#endif
+
     // removing some completions located in inactive grid cells
     void filterCompletions_()
     {
@@ -229,7 +229,7 @@ protected:
 
         Scalar trans = problem.transmissibility(elemCtx, interiorDofIdx_, exteriorDofIdx_);
         Scalar faceArea = scvf.area();
-        Scalar thpres = problem.thresholdPressure(I, J);
+        Scalar thpres = problem.thresholdPressure(elemCtx, interiorDofIdx_, exteriorDofIdx_);
 
         // estimate the gravity correction: for performance reasons we use a simplified
         // approach for this flux module that assumes that gravity is constant and always
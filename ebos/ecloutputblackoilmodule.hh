@@ -33,6 +33,7 @@
 
 #include <ewoms/common/propertysystem.hh>
 #include <ewoms/common/parametersystem.hh>
+#include <ewoms/parallel/locks.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -51,6 +52,8 @@
 #include <dune/common/fvector.hh>
 
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace Ewoms {
 namespace Properties {
@@ -78,6 +81,7 @@ class EclOutputBlackOilModule
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
+    typedef typename GET_PROP_TYPE(TypeTag, IntensiveQuantities) IntensiveQuantities;
     typedef typename GET_PROP_TYPE(TypeTag, MaterialLaw) MaterialLaw;
     typedef typename GET_PROP_TYPE(TypeTag, MaterialLawParams) MaterialLawParams;
     typedef typename GET_PROP_TYPE(TypeTag, FluidSystem) FluidSystem;
@@ -128,6 +132,22 @@ public:
                 }
             }
         }
+
+        // index the block data by the cell so that the entries for a given cell can be
+        // found without searching the whole map
+        for (auto& val : blockData_) {
+            const auto& key = val.first;
+            if (key.first != "BWSAT" && key.first != "BGSAT" && key.first != "BPR") {
+                std::string logstring = "Keyword '";
+                logstring.append(key.first);
+                logstring.append("' is unhandled for output to file.");
+                Opm::OpmLog::warning("Unhandled output keyword", logstring);
+                continue;
+            }
+
+            int globalIdx = key.second - 1;
+            blockDataByCell_[globalIdx].push_back(&val);
+        }
     }
 
     /*!
@@ -349,238 +369,251 @@ public:
      */
     void processElement(const ElementContext& elemCtx)
     {
-
         if (!std::is_same<Discretization, Ewoms::EcfvDiscretization<TypeTag> >::value)
             return;
 
         for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
-            const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-            const auto& fs = intQuants.fluidState();
-
-            typedef typename std::remove_const<typename std::remove_reference<decltype(fs)>::type>::type FluidState;
             unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-            unsigned pvtRegionIdx = elemCtx.primaryVars(dofIdx, /*timeIdx=*/0).pvtRegionIndex();
-
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-                if (saturation_[phaseIdx].size() == 0)
-                    continue;
+            processDof(globalDofIdx, elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0));
+        }
+    }
 
-                saturation_[phaseIdx][globalDofIdx] = Opm::getValue(fs.saturation(phaseIdx));
-                Opm::Valgrind::CheckDefined(saturation_[phaseIdx][globalDofIdx]);
-            }
+    /*!
+     * \brief Modify the internal buffers according to the intensive quanties of a
+     *        single degree of freedom
+     *
+     * This method may be called concurrently by multiple threads as long as they
+     * process distinct degrees of freedom.
+     */
+    void processDof(unsigned globalDofIdx, const IntensiveQuantities& intQuants)
+    {
+        if (!std::is_same<Discretization, Ewoms::EcfvDiscretization<TypeTag> >::value)
+            return;
 
-            if (oilPressure_.size() > 0) {
-                oilPressure_[globalDofIdx] = Opm::getValue(fs.pressure(oilPhaseIdx));
-                Opm::Valgrind::CheckDefined(oilPressure_[globalDofIdx]);
-            }
+        const auto& fs = intQuants.fluidState();
 
-            if (temperature_.size() > 0) {
-                temperature_[globalDofIdx] = Opm::getValue(fs.temperature(oilPhaseIdx));
-                Opm::Valgrind::CheckDefined(temperature_[globalDofIdx]);
-            }
-            if (gasDissolutionFactor_.size() > 0) {
-                Scalar SoMax = elemCtx.problem().maxOilSaturation(globalDofIdx);
-                gasDissolutionFactor_[globalDofIdx] =
-                    FluidSystem::template saturatedDissolutionFactor<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx, SoMax);
-                Opm::Valgrind::CheckDefined(gasDissolutionFactor_[globalDofIdx]);
+        typedef typename std::remove_const<typename std::remove_reference<decltype(fs)>::type>::type FluidState;
+        unsigned pvtRegionIdx = intQuants.pvtRegionIndex();
 
-            }
-            if (oilVaporizationFactor_.size() > 0) {
-                Scalar SoMax = elemCtx.problem().maxOilSaturation(globalDofIdx);
-                oilVaporizationFactor_[globalDofIdx] =
-                    FluidSystem::template saturatedDissolutionFactor<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx, SoMax);
-                Opm::Valgrind::CheckDefined(oilVaporizationFactor_[globalDofIdx]);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (saturation_[phaseIdx].size() == 0)
+                continue;
 
-            }
-            if (gasFormationVolumeFactor_.size() > 0) {
-                gasFormationVolumeFactor_[globalDofIdx] =
-                    1.0/FluidSystem::template inverseFormationVolumeFactor<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx);
-                Opm::Valgrind::CheckDefined(gasFormationVolumeFactor_[globalDofIdx]);
+            saturation_[phaseIdx][globalDofIdx] = Opm::getValue(fs.saturation(phaseIdx));
+            Opm::Valgrind::CheckDefined(saturation_[phaseIdx][globalDofIdx]);
+        }
 
-            }
-            if (saturatedOilFormationVolumeFactor_.size() > 0) {
-                saturatedOilFormationVolumeFactor_[globalDofIdx] =
-                    1.0/FluidSystem::template saturatedInverseFormationVolumeFactor<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
-                Opm::Valgrind::CheckDefined(saturatedOilFormationVolumeFactor_[globalDofIdx]);
+        if (oilPressure_.size() > 0) {
+            oilPressure_[globalDofIdx] = Opm::getValue(fs.pressure(oilPhaseIdx));
+            Opm::Valgrind::CheckDefined(oilPressure_[globalDofIdx]);
+        }
 
-            }
-            if (oilSaturationPressure_.size() > 0) {
-                oilSaturationPressure_[globalDofIdx] =
-                    FluidSystem::template saturationPressure<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
-                Opm::Valgrind::CheckDefined(oilSaturationPressure_[globalDofIdx]);
+        if (temperature_.size() > 0) {
+            temperature_[globalDofIdx] = Opm::getValue(fs.temperature(oilPhaseIdx));
+            Opm::Valgrind::CheckDefined(temperature_[globalDofIdx]);
+        }
+        if (gasDissolutionFactor_.size() > 0) {
+            Scalar SoMax = simulator_.problem().maxOilSaturation(globalDofIdx);
+            gasDissolutionFactor_[globalDofIdx] =
+                FluidSystem::template saturatedDissolutionFactor<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx, SoMax);
+            Opm::Valgrind::CheckDefined(gasDissolutionFactor_[globalDofIdx]);
 
-            }
+        }
+        if (oilVaporizationFactor_.size() > 0) {
+            Scalar SoMax = simulator_.problem().maxOilSaturation(globalDofIdx);
+            oilVaporizationFactor_[globalDofIdx] =
+                FluidSystem::template saturatedDissolutionFactor<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx, SoMax);
+            Opm::Valgrind::CheckDefined(oilVaporizationFactor_[globalDofIdx]);
 
-            if (rs_.size()) {
-                rs_[globalDofIdx] = Opm::getValue(fs.Rs());
-                Opm::Valgrind::CheckDefined(rs_[globalDofIdx]);
-            }
+        }
+        if (gasFormationVolumeFactor_.size() > 0) {
+            gasFormationVolumeFactor_[globalDofIdx] =
+                1.0/FluidSystem::template inverseFormationVolumeFactor<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx);
+            Opm::Valgrind::CheckDefined(gasFormationVolumeFactor_[globalDofIdx]);
 
-            if (rv_.size()) {
-                rv_[globalDofIdx] = Opm::getValue(fs.Rv());
-                Opm::Valgrind::CheckDefined(rv_[globalDofIdx]);
-            }
+        }
+        if (saturatedOilFormationVolumeFactor_.size() > 0) {
+            saturatedOilFormationVolumeFactor_[globalDofIdx] =
+                1.0/FluidSystem::template saturatedInverseFormationVolumeFactor<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
+            Opm::Valgrind::CheckDefined(saturatedOilFormationVolumeFactor_[globalDofIdx]);
 
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-                if (invB_[phaseIdx].size() == 0)
-                    continue;
+        }
+        if (oilSaturationPressure_.size() > 0) {
+            oilSaturationPressure_[globalDofIdx] =
+                FluidSystem::template saturationPressure<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
+            Opm::Valgrind::CheckDefined(oilSaturationPressure_[globalDofIdx]);
 
-                invB_[phaseIdx][globalDofIdx] = Opm::getValue(fs.invB(phaseIdx));
-                Opm::Valgrind::CheckDefined(invB_[phaseIdx][globalDofIdx]);
-            }
+        }
 
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-                if (density_[phaseIdx].size() == 0)
-                    continue;
+        if (rs_.size()) {
+            rs_[globalDofIdx] = Opm::getValue(fs.Rs());
+            Opm::Valgrind::CheckDefined(rs_[globalDofIdx]);
+        }
 
-                density_[phaseIdx][globalDofIdx] = Opm::getValue(fs.density(phaseIdx));
-                Opm::Valgrind::CheckDefined(density_[phaseIdx][globalDofIdx]);
-            }
+        if (rv_.size()) {
+            rv_[globalDofIdx] = Opm::getValue(fs.Rv());
+            Opm::Valgrind::CheckDefined(rv_[globalDofIdx]);
+        }
 
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-                if (viscosity_[phaseIdx].size() == 0)
-                    continue;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (invB_[phaseIdx].size() == 0)
+                continue;
 
-                viscosity_[phaseIdx][globalDofIdx] = Opm::getValue(fs.viscosity(phaseIdx));
-                Opm::Valgrind::CheckDefined(viscosity_[phaseIdx][globalDofIdx]);
-            }
+            invB_[phaseIdx][globalDofIdx] = Opm::getValue(fs.invB(phaseIdx));
+            Opm::Valgrind::CheckDefined(invB_[phaseIdx][globalDofIdx]);
+        }
 
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-                if (relativePermeability_[phaseIdx].size() == 0)
-                    continue;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (density_[phaseIdx].size() == 0)
+                continue;
 
-                relativePermeability_[phaseIdx][globalDofIdx] = Opm::getValue(intQuants.relativePermeability(phaseIdx));
-                Opm::Valgrind::CheckDefined(relativePermeability_[phaseIdx][globalDofIdx]);
-            }
+            density_[phaseIdx][globalDofIdx] = Opm::getValue(fs.density(phaseIdx));
+            Opm::Valgrind::CheckDefined(density_[phaseIdx][globalDofIdx]);
+        }
 
-            if (sSol_.size() > 0) {
-                sSol_[globalDofIdx] = intQuants.solventSaturation().value();
-            }
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (viscosity_[phaseIdx].size() == 0)
+                continue;
 
-            if (cPolymer_.size() > 0) {
-                cPolymer_[globalDofIdx] = intQuants.polymerConcentration().value();
-            }
+            viscosity_[phaseIdx][globalDofIdx] = Opm::getValue(fs.viscosity(phaseIdx));
+            Opm::Valgrind::CheckDefined(viscosity_[phaseIdx][globalDofIdx]);
+        }
 
-            if (bubblePointPressure_.size() > 0)
-            {
-                try {
-                    bubblePointPressure_[globalDofIdx] = Opm::getValue(FluidSystem::bubblePointPressure(fs, intQuants.pvtRegionIndex()));
-                }
-                catch (const Opm::NumericalIssue&) {
-                    const auto globalIdx = elemCtx.simulator().vanguard().grid().globalCell()[globalDofIdx];
-                    failedCellsPb_.push_back(globalIdx);
-                }
-            }
-            if (dewPointPressure_.size() > 0)
-            {
-                try {
-                    dewPointPressure_[globalDofIdx] = Opm::getValue(FluidSystem::dewPointPressure(fs, intQuants.pvtRegionIndex()));
-                }
-                catch (const Opm::NumericalIssue&) {
-                    const auto globalIdx = elemCtx.simulator().vanguard().grid().globalCell()[globalDofIdx];
-                    failedCellsPd_.push_back(globalIdx);
-                }
-            }
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (relativePermeability_[phaseIdx].size() == 0)
+                continue;
 
-            if (soMax_.size() > 0)
-                soMax_[globalDofIdx] = elemCtx.simulator().problem().maxOilSaturation(globalDofIdx);
+            relativePermeability_[phaseIdx][globalDofIdx] = Opm::getValue(intQuants.relativePermeability(phaseIdx));
+            Opm::Valgrind::CheckDefined(relativePermeability_[phaseIdx][globalDofIdx]);
+        }
 
-            const auto& matLawManager = elemCtx.simulator().problem().materialLawManager();
-            if (matLawManager->enableHysteresis()) {
-                if (pcSwMdcOw_.size() > 0 && krnSwMdcOw_.size() > 0) {
-                    matLawManager->oilWaterHysteresisParams(
-                                pcSwMdcOw_[globalDofIdx],
-                                krnSwMdcOw_[globalDofIdx],
-                                globalDofIdx);
-                }
-                if (pcSwMdcGo_.size() > 0 && krnSwMdcGo_.size() > 0) {
-                    matLawManager->gasOilHysteresisParams(
-                                pcSwMdcGo_[globalDofIdx],
-                                krnSwMdcGo_[globalDofIdx],
-                                globalDofIdx);
-                }
-            }
+        if (sSol_.size() > 0) {
+            sSol_[globalDofIdx] = intQuants.solventSaturation().value();
+        }
 
-            // hack to make the intial output of rs and rv Ecl compatible.
-            // For cells with swat == 1 Ecl outputs; rs = rsSat and rv=rvSat, in all but the initial step
-            // where it outputs rs and rv values calculated by the initialization. To be compatible we overwrite
-            // rs and rv with the values computed in the initially.
-            // Volume factors, densities and viscosities need to be recalculated with the updated rs and rv values.
-            // This can be removed when ebos has 100% controll over output
-            if (elemCtx.simulator().episodeIndex() < 0 && FluidSystem::phaseIsActive(oilPhaseIdx) && FluidSystem::phaseIsActive(gasPhaseIdx) ) {
+        if (cPolymer_.size() > 0) {
+            cPolymer_[globalDofIdx] = intQuants.polymerConcentration().value();
+        }
 
-                const auto& fs_initial = elemCtx.simulator().problem().initialFluidState(globalDofIdx);
+        if (bubblePointPressure_.size() > 0)
+        {
+            try {
+                bubblePointPressure_[globalDofIdx] = Opm::getValue(FluidSystem::bubblePointPressure(fs, intQuants.pvtRegionIndex()));
+            }
+            catch (const Opm::NumericalIssue&) {
+                const auto globalIdx = simulator_.vanguard().grid().globalCell()[globalDofIdx];
+                ScopedLock failedCellsLock(failedCellsMutex_);
+                failedCellsPb_.push_back(globalIdx);
+            }
+        }
+        if (dewPointPressure_.size() > 0)
+        {
+            try {
+                dewPointPressure_[globalDofIdx] = Opm::getValue(FluidSystem::dewPointPressure(fs, intQuants.pvtRegionIndex()));
+            }
+            catch (const Opm::NumericalIssue&) {
+                const auto globalIdx = simulator_.vanguard().grid().globalCell()[globalDofIdx];
+                ScopedLock failedCellsLock(failedCellsMutex_);
+                failedCellsPd_.push_back(globalIdx);
+            }
+        }
 
-                // use initial rs and rv values
-                if (rv_.size() > 0)
-                    rv_[globalDofIdx] = fs_initial.Rv();
+        if (soMax_.size() > 0)
+            soMax_[globalDofIdx] = simulator_.problem().maxOilSaturation(globalDofIdx);
 
-                if (rs_.size() > 0)
-                    rs_[globalDofIdx] = fs_initial.Rs();
+        const auto& matLawManager = simulator_.problem().materialLawManager();
+        if (matLawManager->enableHysteresis()) {
+            if (pcSwMdcOw_.size() > 0 && krnSwMdcOw_.size() > 0) {
+                matLawManager->oilWaterHysteresisParams(
+                            pcSwMdcOw_[globalDofIdx],
+                            krnSwMdcOw_[globalDofIdx],
+                            globalDofIdx);
+            }
+            if (pcSwMdcGo_.size() > 0 && krnSwMdcGo_.size() > 0) {
+                matLawManager->gasOilHysteresisParams(
+                            pcSwMdcGo_[globalDofIdx],
+                            krnSwMdcGo_[globalDofIdx],
+                            globalDofIdx);
+            }
+        }
 
-                // re-compute the volume factors, viscosities and densities if asked for
-                if (density_[oilPhaseIdx].size() > 0)
-                    density_[oilPhaseIdx][globalDofIdx] = FluidSystem::density(fs_initial,
+        // hack to make the intial output of rs and rv Ecl compatible.
+        // For cells with swat == 1 Ecl outputs; rs = rsSat and rv=rvSat, in all but the initial step
+        // where it outputs rs and rv values calculated by the initialization. To be compatible we overwrite
+        // rs and rv with the values computed in the initially.
+        // Volume factors, densities and viscosities need to be recalculated with the updated rs and rv values.
+        // This can be removed when ebos has 100% controll over output
+        if (simulator_.episodeIndex() < 0 && FluidSystem::phaseIsActive(oilPhaseIdx) && FluidSystem::phaseIsActive(gasPhaseIdx) ) {
+
+            const auto& fs_initial = simulator_.problem().initialFluidState(globalDofIdx);
+
+            // use initial rs and rv values
+            if (rv_.size() > 0)
+                rv_[globalDofIdx] = fs_initial.Rv();
+
+            if (rs_.size() > 0)
+                rs_[globalDofIdx] = fs_initial.Rs();
+
+            // re-compute the volume factors, viscosities and densities if asked for
+            if (density_[oilPhaseIdx].size() > 0)
+                density_[oilPhaseIdx][globalDofIdx] = FluidSystem::density(fs_initial,
+                                                                                oilPhaseIdx,
+                                                                                intQuants.pvtRegionIndex());
+            if (density_[gasPhaseIdx].size() > 0)
+                density_[gasPhaseIdx][globalDofIdx] = FluidSystem::density(fs_initial,
+                                                                                gasPhaseIdx,
+                                                                                intQuants.pvtRegionIndex());
+
+            if (invB_[oilPhaseIdx].size() > 0)
+                invB_[oilPhaseIdx][globalDofIdx] = FluidSystem::inverseFormationVolumeFactor(fs_initial,
+                                                                                                  oilPhaseIdx,
+                                                                                                  intQuants.pvtRegionIndex());
+            if (invB_[gasPhaseIdx].size() > 0)
+                invB_[gasPhaseIdx][globalDofIdx] = FluidSystem::inverseFormationVolumeFactor(fs_initial,
+                                                                                                  gasPhaseIdx,
+                                                                                                  intQuants.pvtRegionIndex());
+            if (viscosity_[oilPhaseIdx].size() > 0)
+                viscosity_[oilPhaseIdx][globalDofIdx] = FluidSystem::viscosity(fs_initial,
                                                                                     oilPhaseIdx,
                                                                                     intQuants.pvtRegionIndex());
-                if (density_[gasPhaseIdx].size() > 0)
-                    density_[gasPhaseIdx][globalDofIdx] = FluidSystem::density(fs_initial,
+            if (viscosity_[gasPhaseIdx].size() > 0)
+                viscosity_[gasPhaseIdx][globalDofIdx] = FluidSystem::viscosity(fs_initial,
                                                                                     gasPhaseIdx,
                                                                                     intQuants.pvtRegionIndex());
+        }
 
-                if (invB_[oilPhaseIdx].size() > 0)
-                    invB_[oilPhaseIdx][globalDofIdx] = FluidSystem::inverseFormationVolumeFactor(fs_initial,
-                                                                                                      oilPhaseIdx,
-                                                                                                      intQuants.pvtRegionIndex());
-                if (invB_[gasPhaseIdx].size() > 0)
-                    invB_[gasPhaseIdx][globalDofIdx] = FluidSystem::inverseFormationVolumeFactor(fs_initial,
-                                                                                                      gasPhaseIdx,
-                                                                                                      intQuants.pvtRegionIndex());
-                if (viscosity_[oilPhaseIdx].size() > 0)
-                    viscosity_[oilPhaseIdx][globalDofIdx] = FluidSystem::viscosity(fs_initial,
-                                                                                        oilPhaseIdx,
-                                                                                        intQuants.pvtRegionIndex());
-                if (viscosity_[gasPhaseIdx].size() > 0)
-                    viscosity_[gasPhaseIdx][globalDofIdx] = FluidSystem::viscosity(fs_initial,
-                                                                                        gasPhaseIdx,
-                                                                                        intQuants.pvtRegionIndex());
+        // Add fluid in Place values
+        updateFluidInPlace_(globalDofIdx, intQuants);
+
+        // Adding block data. (the entries of the block data map are only modified,
+        // the structure of the map stays the same.)
+        const auto globalIdx = simulator_.vanguard().grid().globalCell()[globalDofIdx];
+        const auto blockDataIt = blockDataByCell_.find(globalIdx);
+        if (blockDataIt != blockDataByCell_.end()) {
+            for (auto* val : blockDataIt->second) {
+                const auto& key = val->first;
+                if (key.first == "BWSAT")
+                    val->second = Opm::getValue(fs.saturation(waterPhaseIdx));
+                else if (key.first == "BGSAT")
+                    val->second = Opm::getValue(fs.saturation(gasPhaseIdx));
+                else if (key.first == "BPR")
+                    val->second = Opm::getValue(fs.pressure(oilPhaseIdx));
             }
+        }
 
-            // Add fluid in Place values
-            updateFluidInPlace_(elemCtx, dofIdx);
-
-            // Adding block data
-            const auto globalIdx = elemCtx.simulator().vanguard().grid().globalCell()[globalDofIdx];
-            for( auto& val : blockData_ ) {
-                const auto& key = val.first;
-                int global_index = key.second - 1;
-                if (global_index == globalIdx) {
-                    if (key.first == "BWSAT") {
-                        val.second = Opm::getValue(fs.saturation(waterPhaseIdx));
-                    } else if (key.first == "BGSAT") {
-                        val.second = Opm::getValue(fs.saturation(gasPhaseIdx));
-                    } else if (key.first == "BPR") {
-                        val.second = Opm::getValue(fs.pressure(oilPhaseIdx));
-                    } else {
-                        std::string logstring = "Keyword '";
-                        logstring.append(key.first);
-                        logstring.append("' is unhandled for output to file.");
-                        Opm::OpmLog::warning("Unhandled output keyword", logstring);
-                    }
-                }
-            }
+        // Adding Well RFT data. (like for the block data, the maps' structure is
+        // not modified here.)
+        auto oilPressIt = oilCompletionPressures_.find(globalIdx);
+        if (oilPressIt != oilCompletionPressures_.end())
+            oilPressIt->second = Opm::getValue(fs.pressure(oilPhaseIdx));
 
-            // Adding Well RFT data
-            if (oilCompletionPressures_.count(globalIdx) > 0) {
-                oilCompletionPressures_[globalIdx] = Opm::getValue(fs.pressure(oilPhaseIdx));
-            }
-            if (waterCompletionSaturations_.count(globalIdx) > 0) {
-                waterCompletionSaturations_[globalIdx] = Opm::getValue(fs.saturation(waterPhaseIdx));
-            }
-            if (gasCompletionSaturations_.count(globalIdx) > 0) {
-                gasCompletionSaturations_[globalIdx] = Opm::getValue(fs.saturation(gasPhaseIdx));
-            }
-        }
+        auto waterSatIt = waterCompletionSaturations_.find(globalIdx);
+        if (waterSatIt != waterCompletionSaturations_.end())
+            waterSatIt->second = Opm::getValue(fs.saturation(waterPhaseIdx));
+
+        auto gasSatIt = gasCompletionSaturations_.find(globalIdx);
+        if (gasSatIt != gasCompletionSaturations_.end())
+            gasSatIt->second = Opm::getValue(fs.saturation(gasPhaseIdx));
     }
 
 
@@ -1065,12 +1098,9 @@ private:
         return comm.rank() == 0;
     }
 
-    void updateFluidInPlace_(const ElementContext& elemCtx, unsigned dofIdx)
+    void updateFluidInPlace_(unsigned globalDofIdx, const IntensiveQuantities& intQuants)
     {
-
-        const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
         const auto& fs = intQuants.fluidState();
-        unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
 
         // Fluid in Place calculations
 
@@ -1082,7 +1112,7 @@ private:
         // returned by the intensive quantities can be outside of the physical
         // range [0, 1] in pathetic cases.
         const double pv =
-            elemCtx.simulator().model().dofTotalVolume(globalDofIdx)
+            simulator_.model().dofTotalVolume(globalDofIdx)
             * intQuants.porosity().value();
 
         if (pressureTimesHydrocarbonVolume_.size() > 0 && pressureTimesPoreVolume_.size() > 0) {
@@ -1343,6 +1373,7 @@ private:
     ScalarBuffer dewPointPressure_;
     std::vector<int> failedCellsPb_;
     std::vector<int> failedCellsPd_;
+    OmpMutex failedCellsMutex_;
     std::vector<int> fipnum_;
     ScalarBuffer fip_[FipDataType::numFipValues];
     ScalarBuffer origTotalValues_;
@@ -1351,6 +1382,7 @@ private:
     ScalarBuffer pressureTimesPoreVolume_;
     ScalarBuffer pressureTimesHydrocarbonVolume_;
     std::map<std::pair<std::string, int>, double> blockData_;
+    std::unordered_map<int, std::vector<std::pair<const std::pair<std::string, int>, double>*> > blockDataByCell_;
     std::map<size_t, Scalar> oilCompletionPressures_;
     std::map<size_t, Scalar> waterCompletionSaturations_;
     std::map<size_t, Scalar> gasCompletionSaturations_;
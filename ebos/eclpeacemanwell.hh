@@ -1014,14 +1014,29 @@ public:
             if (!applies(globalDofIdx))
                 continue;
 
-            DofVariables& dofVars = *dofVariables_.at(globalDofIdx);
-            const auto& intQuants = context.intensiveQuantities(dofIdx, timeIdx);
+            beginIterationAccumulateDof(globalDofIdx, context.intensiveQuantities(dofIdx, timeIdx));
+        }
+    }
 
-            if (iterationIdx_ == 0)
-                dofVars.updateBeginTimestep(intQuants);
+    /*!
+     * \brief Do the DOF specific part at the beginning of each iteration for a single
+     *        degree of freedom which is penetrated by the well.
+     *
+     * This method only modifies the data of the given DOF, i.e., it may be called
+     * concurrently for different DOFs.
+     */
+    void beginIterationAccumulateDof(unsigned globalDofIdx, const IntensiveQuantities& intQuants)
+    {
+        if (wellStatus() == Shut)
+            return;
 
-            dofVars.update(intQuants);
-        }
+        assert(applies(globalDofIdx));
+        DofVariables& dofVars = *dofVariables_.at(globalDofIdx);
+
+        if (iterationIdx_ == 0)
+            dofVars.updateBeginTimestep(intQuants);
+
+        dofVars.update(intQuants);
     }
 
     /*!
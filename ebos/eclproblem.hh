@@ -242,6 +242,9 @@ SET_BOOL_PROP(EclBaseProblem, EnableEclOutput, true);
 // If available, write the ECL output in a non-blocking manner
 SET_BOOL_PROP(EclBaseProblem, EnableAsyncEclOutput, true);
 
+// Allow two report steps to wait for being written by the ECL output thread
+SET_INT_PROP(EclBaseProblem, EclOutputMaxQueuedWrites, 2);
+
 // By default, use single precision for the ECL formated results
 SET_BOOL_PROP(EclBaseProblem, EclOutputDoublePrecision, false);
 
@@ -683,6 +686,18 @@ public:
         }
     }
 
+    /*!
+     * \copydoc FvBaseProblem::finalize
+     */
+    void finalize()
+    {
+        // make sure that all report steps have been written successfully
+        if (eclWriter_)
+            eclWriter_->finalize();
+
+        ParentType::finalize();
+    }
+
     /*!
      * \brief Returns true if the current solution should be written
      *        to disk for visualization.
@@ -833,6 +848,22 @@ public:
     Scalar thresholdPressure(unsigned elem1Idx, unsigned elem2Idx) const
     { return thresholdPressures_.thresholdPressure(elem1Idx, elem2Idx); }
 
+    /*!
+     * \brief Returns the threshold pressure [Pa] for the face between the center
+     *        element of an element context and one of its neighbors.
+     *
+     * In contrast to the variant which takes global element indices, this method does
+     * not need to look up the face in the neighbor table.
+     */
+    template <class Context>
+    Scalar thresholdPressure(const Context& context,
+                             unsigned OPM_OPTIM_UNUSED fromDofLocalIdx,
+                             unsigned toDofLocalIdx) const
+    {
+        assert(fromDofLocalIdx == 0);
+        return thresholdPressures_.faceThresholdPressure(pffDofData_.get(context.element(), toDofLocalIdx).faceIdx);
+    }
+
     /*!
      * \copydoc FvBaseMultiPhaseProblem::porosity
      */
@@ -1932,6 +1963,7 @@ private:
     {
         Opm::ConditionalStorage<enableEnergy, Scalar> thermalHalfTrans;
         Scalar transmissibility;
+        unsigned faceIdx;
     };
 
     // update the prefetch friendly data object
@@ -1948,10 +1980,11 @@ private:
             unsigned globalElemIdx = elementMapper.index(stencil.entity(localDofIdx));
             if (localDofIdx != 0) {
                 unsigned globalCenterElemIdx = elementMapper.index(stencil.entity(/*dofIdx=*/0));
-                dofData.transmissibility = transmissibilities_.transmissibility(globalCenterElemIdx, globalElemIdx);
+                dofData.faceIdx = transmissibilities_.faceIndex(globalCenterElemIdx, globalElemIdx);
+                dofData.transmissibility = transmissibilities_.faceTransmissibility(dofData.faceIdx);
 
                 if (enableEnergy)
-                    *dofData.thermalHalfTrans = transmissibilities_.thermalHalfTrans(globalCenterElemIdx, globalElemIdx);
+                    *dofData.thermalHalfTrans = transmissibilities_.faceThermalHalfTrans(dofData.faceIdx);
             }
         };
 
@@ -133,6 +133,7 @@ public:
 
         computeDefaultThresholdPressures_();
         applyExplicitThresholdPressures_();
+        updateFaceThresholdPressures_();
     }
 
     /*!
@@ -148,13 +149,20 @@ public:
         if (!enableThresholdPressure_)
             return 0.0;
 
-        unsigned short equilRegion1Idx = elemEquilRegion_[elemIdx1];
-        unsigned short equilRegion2Idx = elemEquilRegion_[elemIdx2];
+        const auto& trans = simulator_.problem().eclTransmissibilities();
+        return thpresFace_[trans.faceIndex(elemIdx1, elemIdx2)];
+    }
 
-        if (equilRegion1Idx == equilRegion2Idx)
+    /*!
+     * \brief Returns the theshold pressure [Pa] for a face of the neighbor table of the
+     *        transmissibilities.
+     */
+    Scalar faceThresholdPressure(unsigned faceIdx) const
+    {
+        if (!enableThresholdPressure_)
             return 0.0;
 
-        return thpres_[equilRegion1Idx*numEquilRegions_ + equilRegion2Idx];
+        return thpresFace_[faceIdx];
     }
 
 private:
@@ -289,10 +297,32 @@ private:
         }
     }
 
+    // distribute the threshold pressures of the EQUIL region boundaries to the faces
+    // of the neighbor table used for the transmissibilities
+    void updateFaceThresholdPressures_()
+    {
+        const auto& trans = simulator_.problem().eclTransmissibilities();
+        unsigned numElements = elemEquilRegion_.size();
+
+        thpresFace_.resize(trans.numFaces());
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            unsigned short equilRegion1Idx = elemEquilRegion_[elemIdx];
+            for (unsigned faceIdx = trans.faceBegin(elemIdx); faceIdx < trans.faceEnd(elemIdx); ++faceIdx) {
+                unsigned short equilRegion2Idx = elemEquilRegion_[trans.neighbor(faceIdx)];
+
+                if (equilRegion1Idx == equilRegion2Idx)
+                    thpresFace_[faceIdx] = 0.0;
+                else
+                    thpresFace_[faceIdx] = thpres_[equilRegion1Idx*numEquilRegions_ + equilRegion2Idx];
+            }
+        }
+    }
+
     const Simulator& simulator_;
 
     std::vector<Scalar> thpresDefault_;
     std::vector<Scalar> thpres_;
+    std::vector<Scalar> thpresFace_;
     unsigned numEquilRegions_;
     std::vector<unsigned char> elemEquilRegion_;
 
@@ -46,9 +46,16 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <ewoms/parallel/threadedentityiterator.hh>
+#include <ewoms/parallel/threadmanager.hh>
+
+#include <algorithm>
 #include <array>
+#include <exception>
 #include <vector>
-#include <unordered_map>
+#include <stdexcept>
+#include <string>
+#include <cassert>
 
 namespace Ewoms {
 namespace Properties {
@@ -139,9 +146,8 @@ public:
         for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
             axisCentroids[dimIdx].resize(numElements);
 
-        auto elemIt = gridView.template begin</*codim=*/ 0>();
         const auto& elemEndIt = gridView.template end</*codim=*/ 0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
+        for (auto elemIt = gridView.template begin</*codim=*/ 0>(); elemIt != elemEndIt; ++elemIt) {
             const auto& elem = *elemIt;
             unsigned elemIdx = elemMapper.index(elem);
 
@@ -155,196 +161,231 @@ public:
                     axisCentroids[axisIdx][elemIdx][dimIdx] = centroid[dimIdx];
         }
 
-        // reserving some space in the hashmap upfront saves quite a bit of time because
-        // resizes are costly for hashmaps and there would be quite a few of them if we
-        // would not have a rough idea of how large the final map will be (the rough idea
-        // is a conforming Cartesian grid).
-        trans_.clear();
-        trans_.reserve(numElements*3*1.05);
+        // determine the neighborhood of all elements. this is a sequential pass over
+        // the grid, but it is cheap compared to computing the transmissibilities.
+        updateTopology_(elemMapper);
 
-        transBoundary_.clear();
+        faceTrans_.resize(neighbors_.size());
+        std::fill(faceTrans_.begin(), faceTrans_.end(), 0.0);
+        boundaryTrans_.resize(boundaryOffsets_.back());
+        std::fill(boundaryTrans_.begin(), boundaryTrans_.end(), 0.0);
 
         // if energy is enabled, let's do the same for the "thermal half transmissibilities"
         if (enableEnergy) {
-            thermalHalfTrans_->clear();
-            thermalHalfTrans_->reserve(numElements*6*1.05);
-
-            thermalHalfTransBoundary_.clear();
+            faceThermalHalfTrans_->resize(neighbors_.size());
+            std::fill(faceThermalHalfTrans_->begin(), faceThermalHalfTrans_->end(), 0.0);
+            boundaryThermalHalfTrans_->resize(boundaryOffsets_.back());
+            std::fill(boundaryThermalHalfTrans_->begin(), boundaryThermalHalfTrans_->end(), 0.0);
         }
 
-        // compute the transmissibilities for all intersections
-        elemIt = gridView.template begin</*codim=*/ 0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
-            const auto& elem = *elemIt;
-            unsigned elemIdx = elemMapper.index(elem);
-
-            auto isIt = gridView.ibegin(elem);
-            const auto& isEndIt = gridView.iend(elem);
-            unsigned boundaryIsIdx = 0;
-            for (; isIt != isEndIt; ++ isIt) {
-                // store intersection, this might be costly
-                const auto& intersection = *isIt;
-
-                // deal with grid boundaries
-                if (intersection.boundary()) {
-                    // compute the transmissibilty for the boundary intersection
-                    const auto& geometry = intersection.geometry();
-                    const auto& faceCenterInside = geometry.center();
-
-                    auto faceAreaNormal = intersection.centerUnitOuterNormal();
-                    faceAreaNormal *= geometry.volume();
-
-                    Scalar transBoundaryIs;
-                    computeHalfTrans_(transBoundaryIs,
-                                      faceAreaNormal,
-                                      intersection.indexInInside(),
-                                      distanceVector_(faceCenterInside,
-                                                      intersection.indexInInside(),
-                                                      elemIdx,
-                                                      axisCentroids),
-                                      permeability_[elemIdx]);
-
-                    // normally there would be two half-transmissibilities that would be
-                    // averaged. on the grid boundary there only is the half
-                    // transmissibility of the interior element.
-                    transBoundary_[std::make_pair(elemIdx, boundaryIsIdx)] = transBoundaryIs;
-
-                    // for boundary intersections we also need to compute the thermal
-                    // half transmissibilities
-                    if (enableEnergy) {
-                        const auto& n = intersection.centerUnitOuterNormal();
-                        const auto& inPos = elem.geometry().center();
-                        const auto& outPos = intersection.geometry().center();
-                        const auto& d = outPos - inPos;
-
-                        // eWoms expects fluxes to be area specific, i.e. we must *not*
-                        // the transmissibility with the face area here
-                        Scalar thermalHalfTrans = std::abs(n*d)/(d*d);
-
-                        thermalHalfTransBoundary_[std::make_pair(elemIdx, boundaryIsIdx)] =
-                            thermalHalfTrans;
+        // compute the transmissibilities for all intersections. every entry of the
+        // face arrays is written by exactly one thread: the thermal half
+        // transmissibilities and the boundary values by the thread which deals with the
+        // inside element, the transmissibility of an interior face by the thread which
+        // deals with the element exhibiting the smaller index.
+        //
+        // exceptions must not leave the parallel region, so the first one is re-thrown
+        // after the loop. the transmissibilities are computed before the model exists,
+        // so the elements are partitioned into chunks here.
+        EntityChunks<GridView, /*codim=*/0> elementChunks;
+        elementChunks.update(gridView, ThreadManager<TypeTag>::maxThreads(), /*sequenceNumber=*/0);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks);
+        std::exception_ptr exception;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            try {
+                auto elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const auto& elem = *elemIt;
+                    unsigned elemIdx = elemMapper.index(elem);
+
+                    auto isIt = gridView.ibegin(elem);
+                    const auto& isEndIt = gridView.iend(elem);
+                    unsigned boundaryIsIdx = 0;
+                    for (; isIt != isEndIt; ++ isIt) {
+                        // store intersection, this might be costly
+                        const auto& intersection = *isIt;
+
+                        // deal with grid boundaries
+                        if (intersection.boundary()) {
+                            unsigned boundaryFaceIdx = boundaryOffsets_[elemIdx] + boundaryIsIdx;
+
+                            // compute the transmissibilty for the boundary intersection
+                            const auto& geometry = intersection.geometry();
+                            const auto& faceCenterInside = geometry.center();
+
+                            auto faceAreaNormal = intersection.centerUnitOuterNormal();
+                            faceAreaNormal *= geometry.volume();
+
+                            Scalar transBoundaryIs;
+                            computeHalfTrans_(transBoundaryIs,
+                                              faceAreaNormal,
+                                              intersection.indexInInside(),
+                                              distanceVector_(faceCenterInside,
+                                                              intersection.indexInInside(),
+                                                              elemIdx,
+                                                              axisCentroids),
+                                              permeability_[elemIdx]);
+
+                            // normally there would be two half-transmissibilities that would be
+                            // averaged. on the grid boundary there only is the half
+                            // transmissibility of the interior element.
+                            boundaryTrans_[boundaryFaceIdx] = transBoundaryIs;
+
+                            // for boundary intersections we also need to compute the thermal
+                            // half transmissibilities
+                            if (enableEnergy) {
+                                const auto& n = intersection.centerUnitOuterNormal();
+                                const auto& inPos = elem.geometry().center();
+                                const auto& outPos = intersection.geometry().center();
+                                const auto& d = outPos - inPos;
+
+                                // eWoms expects fluxes to be area specific, i.e. we must *not*
+                                // the transmissibility with the face area here
+                                Scalar thermalHalfTrans = std::abs(n*d)/(d*d);
+
+                                (*boundaryThermalHalfTrans_)[boundaryFaceIdx] = thermalHalfTrans;
+                            }
+
+                            ++ boundaryIsIdx;
+                            continue;
+                        }
+
+                        if (!intersection.neighbor())
+                            // elements can be on process boundaries, i.e. they are not on the
+                            // domain boundary yet they don't have neighbors.
+                            continue;
+
+                        const auto& outsideElem = intersection.outside();
+                        unsigned outsideElemIdx = elemMapper.index(outsideElem);
+                        unsigned faceIdx = faceIndex(elemIdx, outsideElemIdx);
+
+                        // update the "thermal half transmissibility" for the intersection
+                        if (enableEnergy) {
+                            const auto& n = intersection.centerUnitOuterNormal();
+                            Scalar A = intersection.geometry().volume();
+
+                            const auto& inPos = elem.geometry().center();
+                            const auto& outPos = intersection.geometry().center();
+                            const auto& d = outPos - inPos;
+
+                            (*faceThermalHalfTrans_)[faceIdx] = A * (n*d)/(d*d);
+                        }
+
+                        // we only need to calculate a face's transmissibility
+                        // once...
+                        if (elemIdx > outsideElemIdx)
+                            continue;
+
+                        unsigned insideCartElemIdx = cartMapper.cartesianIndex(elemIdx);
+                        unsigned outsideCartElemIdx = cartMapper.cartesianIndex(outsideElemIdx);
+
+                        // local indices of the faces of the inside and
+                        // outside elements which contain the intersection
+                        unsigned insideFaceIdx  = intersection.indexInInside();
+                        unsigned outsideFaceIdx = intersection.indexInOutside();
+
+                        DimVector faceCenterInside;
+                        DimVector faceCenterOutside;
+                        DimVector faceAreaNormal;
+
+                        typename std::is_same<Grid, Dune::CpGrid>::type isCpGrid;
+                        computeFaceProperties(intersection,
+                                              elemIdx,
+                                              insideFaceIdx,
+                                              outsideElemIdx,
+                                              outsideFaceIdx,
+                                              faceCenterInside,
+                                              faceCenterOutside,
+                                              faceAreaNormal,
+                                              isCpGrid);
+
+                        Scalar halfTrans1;
+                        Scalar halfTrans2;
+
+                        computeHalfTrans_(halfTrans1,
+                                          faceAreaNormal,
+                                          insideFaceIdx,
+                                          distanceVector_(faceCenterInside,
+                                                          intersection.indexInInside(),
+                                                          elemIdx,
+                                                          axisCentroids),
+                                          permeability_[elemIdx]);
+                        computeHalfTrans_(halfTrans2,
+                                          faceAreaNormal,
+                                          outsideFaceIdx,
+                                          distanceVector_(faceCenterOutside,
+                                                          intersection.indexInOutside(),
+                                                          outsideElemIdx,
+                                                          axisCentroids),
+                                          permeability_[outsideElemIdx]);
+
+                        applyNtg_(halfTrans1, insideFaceIdx, insideCartElemIdx, ntg);
+                        applyNtg_(halfTrans2, outsideFaceIdx, outsideCartElemIdx, ntg);
+
+                        // convert half transmissibilities to full face
+                        // transmissibilities using the harmonic mean
+                        Scalar trans;
+                        if (std::abs(halfTrans1) < 1e-30 || std::abs(halfTrans2) < 1e-30)
+                            // avoid division by zero
+                            trans = 0.0;
+                        else
+                            trans = 1.0 / (1.0/halfTrans1 + 1.0/halfTrans2);
+
+                        // apply the full face transmissibility multipliers
+                        // for the inside ...
+                        applyMultipliers_(trans, insideFaceIdx, insideCartElemIdx, transMult);
+                        // ... and outside elements
+                        applyMultipliers_(trans, outsideFaceIdx, outsideCartElemIdx, transMult);
+
+                        // apply the region multipliers (cf. the MULTREGT keyword)
+                        Opm::FaceDir::DirEnum faceDir;
+                        switch (insideFaceIdx) {
+                        case 0:
+                        case 1:
+                            faceDir = Opm::FaceDir::XPlus;
+                            break;
+
+                        case 2:
+                        case 3:
+                            faceDir = Opm::FaceDir::YPlus;
+                            break;
+
+                        case 4:
+                        case 5:
+                            faceDir = Opm::FaceDir::ZPlus;
+                            break;
+
+                        default:
+                            throw std::logic_error("Could not determine a face direction");
+                        }
+
+                        trans *= transMult.getRegionMultiplier(insideCartElemIdx,
+                                                               outsideCartElemIdx,
+                                                               faceDir);
+
+                        // the transmissibility is symmetric, i.e., it is stored for both
+                        // directions of the face
+                        faceTrans_[faceIdx] = trans;
+                        faceTrans_[faceIndex(outsideElemIdx, elemIdx)] = trans;
                     }
-
-                    ++ boundaryIsIdx;
-                    continue;
-                }
-
-                if (!intersection.neighbor())
-                    // elements can be on process boundaries, i.e. they are not on the
-                    // domain boundary yet they don't have neighbors.
-                    continue;
-
-                const auto& outsideElem = intersection.outside();
-                unsigned outsideElemIdx = elemMapper.index(outsideElem);
-
-                // update the "thermal half transmissibility" for the intersection
-                if (enableEnergy) {
-                    const auto& n = intersection.centerUnitOuterNormal();
-                    Scalar A = intersection.geometry().volume();
-
-                    const auto& inPos = elem.geometry().center();
-                    const auto& outPos = intersection.geometry().center();
-                    const auto& d = outPos - inPos;
-
-                    (*thermalHalfTrans_)[directionalIsId_(elemIdx, outsideElemIdx)] =
-                        A * (n*d)/(d*d);
                 }
-
-                // we only need to calculate a face's transmissibility
-                // once...
-                if (elemIdx > outsideElemIdx)
-                    continue;
-
-                unsigned insideCartElemIdx = cartMapper.cartesianIndex(elemIdx);
-                unsigned outsideCartElemIdx = cartMapper.cartesianIndex(outsideElemIdx);
-
-                // local indices of the faces of the inside and
-                // outside elements which contain the intersection
-                unsigned insideFaceIdx  = intersection.indexInInside();
-                unsigned outsideFaceIdx = intersection.indexInOutside();
-
-                DimVector faceCenterInside;
-                DimVector faceCenterOutside;
-                DimVector faceAreaNormal;
-
-                typename std::is_same<Grid, Dune::CpGrid>::type isCpGrid;
-                computeFaceProperties(intersection,
-                                      elemIdx,
-                                      insideFaceIdx,
-                                      outsideElemIdx,
-                                      outsideFaceIdx,
-                                      faceCenterInside,
-                                      faceCenterOutside,
-                                      faceAreaNormal,
-                                      isCpGrid);
-
-                Scalar halfTrans1;
-                Scalar halfTrans2;
-
-                computeHalfTrans_(halfTrans1,
-                                  faceAreaNormal,
-                                  insideFaceIdx,
-                                  distanceVector_(faceCenterInside,
-                                                  intersection.indexInInside(),
-                                                  elemIdx,
-                                                  axisCentroids),
-                                  permeability_[elemIdx]);
-                computeHalfTrans_(halfTrans2,
-                                  faceAreaNormal,
-                                  outsideFaceIdx,
-                                  distanceVector_(faceCenterOutside,
-                                                  intersection.indexInOutside(),
-                                                  outsideElemIdx,
-                                                  axisCentroids),
-                                  permeability_[outsideElemIdx]);
-
-                applyNtg_(halfTrans1, insideFaceIdx, insideCartElemIdx, ntg);
-                applyNtg_(halfTrans2, outsideFaceIdx, outsideCartElemIdx, ntg);
-
-                // convert half transmissibilities to full face
-                // transmissibilities using the harmonic mean
-                Scalar trans;
-                if (std::abs(halfTrans1) < 1e-30 || std::abs(halfTrans2) < 1e-30)
-                    // avoid division by zero
-                    trans = 0.0;
-                else
-                    trans = 1.0 / (1.0/halfTrans1 + 1.0/halfTrans2);
-
-                // apply the full face transmissibility multipliers
-                // for the inside ...
-                applyMultipliers_(trans, insideFaceIdx, insideCartElemIdx, transMult);
-                // ... and outside elements
-                applyMultipliers_(trans, outsideFaceIdx, outsideCartElemIdx, transMult);
-
-                // apply the region multipliers (cf. the MULTREGT keyword)
-                Opm::FaceDir::DirEnum faceDir;
-                switch (insideFaceIdx) {
-                case 0:
-                case 1:
-                    faceDir = Opm::FaceDir::XPlus;
-                    break;
-
-                case 2:
-                case 3:
-                    faceDir = Opm::FaceDir::YPlus;
-                    break;
-
-                case 4:
-                case 5:
-                    faceDir = Opm::FaceDir::ZPlus;
-                    break;
-
-                default:
-                    throw std::logic_error("Could not determine a face direction");
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!exception)
+                        exception = std::current_exception();
                 }
-
-                trans *= transMult.getRegionMultiplier(insideCartElemIdx,
-                                                       outsideCartElemIdx,
-                                                       faceDir);
-
-                trans_[isId_(elemIdx, outsideElemIdx)] = trans;
             }
         }
+
+        if (exception)
+            std::rethrow_exception(exception);
     }
 
     /*!
@@ -353,17 +394,82 @@ public:
     const DimMatrix& permeability(unsigned elemIdx) const
     { return permeability_[elemIdx]; }
 
+    /*!
+     * \brief Return the number of neighbors of an element.
+     */
+    unsigned numNeighbors(unsigned elemIdx) const
+    { return neighborOffsets_[elemIdx + 1] - neighborOffsets_[elemIdx]; }
+
+    /*!
+     * \brief Return the total number of faces of the neighbor table.
+     *
+     * Every intersection between two elements is counted twice, i.e., once for each
+     * direction.
+     */
+    size_t numFaces() const
+    { return neighbors_.size(); }
+
+    /*!
+     * \brief Return the index of the first face of an element.
+     *
+     * The faces of an element are numbered contiguously and they are ordered by the
+     * index of the neighboring element, i.e., the ordering is the same as the one of
+     * the rows of the Jacobian matrix.
+     */
+    unsigned faceBegin(unsigned elemIdx) const
+    { return neighborOffsets_[elemIdx]; }
+
+    /*!
+     * \brief Return the index after the last face of an element.
+     */
+    unsigned faceEnd(unsigned elemIdx) const
+    { return neighborOffsets_[elemIdx + 1]; }
+
+    /*!
+     * \brief Return the index of the outside element of a face.
+     */
+    unsigned neighbor(unsigned faceIdx) const
+    { return neighbors_[faceIdx]; }
+
+    /*!
+     * \brief Return the index of the face between an inside and an outside element.
+     *
+     * Since the number of neighbors of an element is small, this is quite cheap, but if
+     * possible, the face index should be determined once and then be reused.
+     */
+    unsigned faceIndex(unsigned insideElemIdx, unsigned outsideElemIdx) const
+    {
+        const auto& beginIt = neighbors_.begin() + neighborOffsets_[insideElemIdx];
+        const auto& endIt = neighbors_.begin() + neighborOffsets_[insideElemIdx + 1];
+        const auto& it = std::lower_bound(beginIt, endIt, outsideElemIdx);
+        if (it == endIt || *it != outsideElemIdx)
+            throw std::out_of_range("Elements "+std::to_string(insideElemIdx)
+                                    +" and "+std::to_string(outsideElemIdx)
+                                    +" are not neighbors");
+
+        return static_cast<unsigned>(it - neighbors_.begin());
+    }
+
     /*!
      * \brief Return the transmissibility for the intersection between two elements.
      */
     Scalar transmissibility(unsigned elemIdx1, unsigned elemIdx2) const
-    { return trans_.at(isId_(elemIdx1, elemIdx2)); }
+    { return faceTrans_[faceIndex(elemIdx1, elemIdx2)]; }
+
+    /*!
+     * \brief Return the transmissibility of a face of the neighbor table.
+     */
+    Scalar faceTransmissibility(unsigned faceIdx) const
+    { return faceTrans_[faceIdx]; }
 
     /*!
      * \brief Return the transmissibility for a given boundary segment.
      */
     Scalar transmissibilityBoundary(unsigned elemIdx, unsigned boundaryFaceIdx) const
-    { return transBoundary_.at(std::make_pair(elemIdx, boundaryFaceIdx)); }
+    {
+        assert(boundaryOffsets_[elemIdx] + boundaryFaceIdx < boundaryOffsets_[elemIdx + 1]);
+        return boundaryTrans_[boundaryOffsets_[elemIdx] + boundaryFaceIdx];
+    }
 
     /*!
      * \brief Return the thermal "half transmissibility" for the intersection between two
@@ -380,10 +486,20 @@ public:
      * cell and the center of the intersection.
      */
     Scalar thermalHalfTrans(unsigned insideElemIdx, unsigned outsideElemIdx) const
-    { return thermalHalfTrans_->at(directionalIsId_(insideElemIdx, outsideElemIdx)); }
+    { return (*faceThermalHalfTrans_)[faceIndex(insideElemIdx, outsideElemIdx)]; }
+
+    /*!
+     * \brief Return the thermal "half transmissibility" of a face of the neighbor
+     *        table.
+     */
+    Scalar faceThermalHalfTrans(unsigned faceIdx) const
+    { return (*faceThermalHalfTrans_)[faceIdx]; }
 
     Scalar thermalHalfTransBoundary(unsigned insideElemIdx, unsigned boundaryFaceIdx) const
-    { return thermalHalfTransBoundary_.at(std::make_pair(insideElemIdx, boundaryFaceIdx)); }
+    {
+        assert(boundaryOffsets_[insideElemIdx] + boundaryFaceIdx < boundaryOffsets_[insideElemIdx + 1]);
+        return (*boundaryThermalHalfTrans_)[boundaryOffsets_[insideElemIdx] + boundaryFaceIdx];
+    }
 
 private:
     template <class Intersection>
@@ -459,21 +575,51 @@ private:
                                    "(The PERM{X,Y,Z} keywords are missing)");
     }
 
-    std::uint64_t isId_(unsigned elemIdx1, unsigned elemIdx2) const
+    // determine the neighbors and the number of boundary intersections of all elements
+    void updateTopology_(const ElementMapper& elemMapper)
     {
-        static const unsigned elemIdxShift = 32; // bits
+        const auto& gridView = vanguard_.gridView();
+        unsigned numElements = elemMapper.size();
 
-        unsigned elemAIdx = std::min(elemIdx1, elemIdx2);
-        std::uint64_t elemBIdx = std::max(elemIdx1, elemIdx2);
+        neighborOffsets_.resize(numElements + 1);
+        boundaryOffsets_.resize(numElements + 1);
+        neighbors_.clear();
+        // the rough idea of the size is a conforming Cartesian grid
+        neighbors_.reserve(numElements*6);
 
-        return (elemBIdx<<elemIdxShift) + elemAIdx;
-    }
+        std::vector<unsigned> numBoundaryIs(numElements, 0);
+        std::vector<std::vector<unsigned> > neighborsOfElem(numElements);
+        auto elemIt = gridView.template begin</*codim=*/ 0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/ 0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const auto& elem = *elemIt;
+            unsigned elemIdx = elemMapper.index(elem);
 
-    std::uint64_t directionalIsId_(unsigned elemIdx1, unsigned elemIdx2) const
-    {
-        static const unsigned elemIdxShift = 32; // bits
+            auto& elemNeighbors = neighborsOfElem[elemIdx];
+            auto isIt = gridView.ibegin(elem);
+            const auto& isEndIt = gridView.iend(elem);
+            for (; isIt != isEndIt; ++ isIt) {
+                const auto& intersection = *isIt;
+                if (intersection.boundary())
+                    ++ numBoundaryIs[elemIdx];
+                else if (intersection.neighbor())
+                    elemNeighbors.push_back(elemMapper.index(intersection.outside()));
+            }
 
-        return (std::uint64_t(elemIdx1)<<elemIdxShift) + elemIdx2;
+            std::sort(elemNeighbors.begin(), elemNeighbors.end());
+            elemNeighbors.erase(std::unique(elemNeighbors.begin(), elemNeighbors.end()),
+                                elemNeighbors.end());
+        }
+
+        // convert the per-element neighbor lists to the compressed format
+        neighborOffsets_[0] = 0;
+        boundaryOffsets_[0] = 0;
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            const auto& elemNeighbors = neighborsOfElem[elemIdx];
+            neighbors_.insert(neighbors_.end(), elemNeighbors.begin(), elemNeighbors.end());
+            neighborOffsets_[elemIdx + 1] = neighbors_.size();
+            boundaryOffsets_[elemIdx + 1] = boundaryOffsets_[elemIdx] + numBoundaryIs[elemIdx];
+        }
     }
 
     void computeHalfTrans_(Scalar& halfTrans,
@@ -608,11 +754,20 @@ private:
 
     const Vanguard& vanguard_;
     std::vector<DimMatrix> permeability_;
-    std::unordered_map<std::uint64_t, Scalar> trans_;
-    std::map<std::pair<unsigned, unsigned>, Scalar> transBoundary_;
-    std::map<std::pair<unsigned, unsigned>, Scalar> thermalHalfTransBoundary_;
-    Opm::ConditionalStorage<enableEnergy,
-                            std::unordered_map<std::uint64_t, Scalar> > thermalHalfTrans_;
+
+    // the neighbor table in compressed row format: the faces of element i are
+    // [neighborOffsets_[i], neighborOffsets_[i + 1]) and neighbors_ stores the index of
+    // the outside element for each of them
+    std::vector<unsigned> neighborOffsets_;
+    std::vector<unsigned> neighbors_;
+    std::vector<Scalar> faceTrans_;
+    Opm::ConditionalStorage<enableEnergy, std::vector<Scalar> > faceThermalHalfTrans_;
+
+    // the same for the boundary intersections. these are ordered like the boundary
+    // intersections of the element's intersection iterator
+    std::vector<unsigned> boundaryOffsets_;
+    std::vector<Scalar> boundaryTrans_;
+    Opm::ConditionalStorage<enableEnergy, std::vector<Scalar> > boundaryThermalHalfTrans_;
 };
 
 } // namespace Ewoms
@@ -42,10 +42,10 @@
 #include <opm/material/common/Exceptions.hpp>
 
 #include <ewoms/common/propertysystem.hh>
-#include <ewoms/parallel/threadedentityiterator.hh>
 
 #include <dune/grid/common/gridenums.hh>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -71,6 +71,7 @@ class EclWellManager
     typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
     typedef typename GET_PROP_TYPE(TypeTag, FluidSystem) FluidSystem;
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
+    typedef typename GET_PROP_TYPE(TypeTag, IntensiveQuantities) IntensiveQuantities;
     typedef typename GET_PROP_TYPE(TypeTag, RateVector) RateVector;
 
     enum { numEq = GET_PROP_VALUE(TypeTag, NumEq) };
@@ -399,24 +400,46 @@ public:
         for (size_t wellIdx = 0; wellIdx < wellSize; ++wellIdx)
             wells_[wellIdx]->beginIterationPreProcess();
 
-        // call the accumulation routines
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(simulator_.vanguard().gridView());
+        // call the accumulation routines. only the elements which are penetrated by a
+        // well need to be considered for this.
+        const auto& model = simulator_.model();
+        int numPenetratedElems = static_cast<int>(penetratedElems_.size());
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel if (numPenetratedElems > 1)
 #endif
         {
             ElementContext elemCtx(simulator_);
-            auto elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
-
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 4)
+#endif
+            for (int penElemIdx = 0; penElemIdx < numPenetratedElems; ++penElemIdx) {
+                const Element& elem = penetratedElems_[penElemIdx];
                 elemCtx.updatePrimaryStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
 
-                for (size_t wellIdx = 0; wellIdx < wellSize; ++wellIdx)
-                    wells_[wellIdx]->beginIterationAccumulate(elemCtx, /*timeIdx=*/0);
+                bool intQuantsUpdated = false;
+                for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
+                    unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                    // use the intensive quantities of the cache if possible
+                    const IntensiveQuantities* intQuants =
+                        model.cachedIntensiveQuantities(globalDofIdx, /*timeIdx=*/0);
+                    if (!intQuants) {
+                        if (!intQuantsUpdated) {
+                            elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+                            intQuantsUpdated = true;
+                        }
+                        intQuants = &elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+                    }
+
+                    for (unsigned i = penetratedElemWellOffsets_[penElemIdx];
+                         i < penetratedElemWellOffsets_[penElemIdx + 1];
+                         ++i)
+                    {
+                        const auto& well = wells_[penetratedElemWells_[i]];
+                        if (well->applies(globalDofIdx))
+                            well->beginIterationAccumulateDof(globalDofIdx, *intQuants);
+                    }
+                }
             }
         }
 
@@ -605,7 +628,7 @@ protected:
 
     void updateWellTopology_(unsigned reportStepIdx OPM_UNUSED,
                              const WellCompletionsMap& wellCompletions,
-                             std::vector<bool>& gridDofIsPenetrated) const
+                             std::vector<bool>& gridDofIsPenetrated)
     {
         auto& model = simulator_.model();
         const auto& vanguard = simulator_.vanguard();
@@ -626,6 +649,12 @@ protected:
         gridDofIsPenetrated.resize(model.numGridDof());
         std::fill(gridDofIsPenetrated.begin(), gridDofIsPenetrated.end(), false);
 
+        // also create the index which maps the penetrated elements to the wells
+        penetratedElems_.clear();
+        penetratedElemWells_.clear();
+        penetratedElemWellOffsets_.clear();
+        penetratedElemWellOffsets_.push_back(0);
+
         ElementContext elemCtx(simulator_);
         auto elemIt = gridView.template begin</*codim=*/0>();
         const auto elemEndIt = gridView.template end</*codim=*/0>();
@@ -635,6 +664,7 @@ protected:
             if (elem.partitionType() != Dune::InteriorEntity)
                 continue; // non-local entities need to be skipped
 
+            size_t numElemWellsBefore = penetratedElemWells_.size();
             elemCtx.updateStencil(elem);
             for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++ dofIdx) {
                 unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
@@ -651,6 +681,16 @@ protected:
                 eclWell->addDof(elemCtx, dofIdx);
 
                 wells.insert(eclWell);
+
+                unsigned wellIdx = wellIndex(eclWell->name());
+                const auto& elemWellsBegin = penetratedElemWells_.begin() + numElemWellsBefore;
+                if (std::find(elemWellsBegin, penetratedElemWells_.end(), wellIdx) == penetratedElemWells_.end())
+                    penetratedElemWells_.push_back(wellIdx);
+            }
+
+            if (penetratedElemWells_.size() > numElemWellsBefore) {
+                penetratedElems_.push_back(elem);
+                penetratedElemWellOffsets_.push_back(penetratedElemWells_.size());
             }
             //////
         }
@@ -795,6 +835,13 @@ protected:
 
     std::vector<std::shared_ptr<Well> > wells_;
     std::vector<bool> gridDofIsPenetrated_;
+
+    // the interior elements which are penetrated by at least one well and, in
+    // compressed row format, the indices of the wells which penetrate them
+    std::vector<Element> penetratedElems_;
+    std::vector<unsigned> penetratedElemWellOffsets_;
+    std::vector<unsigned> penetratedElemWells_;
+
     std::map<std::string, int> wellNameToIndex_;
     std::map<std::string, std::array<Scalar, numPhases> > wellTotalInjectedVolume_;
     std::map<std::string, std::array<Scalar, numPhases> > wellTotalProducedVolume_;
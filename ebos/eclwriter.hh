@@ -34,6 +34,7 @@
 #include <ewoms/disc/ecfv/ecfvdiscretization.hh>
 #include <ewoms/io/baseoutputwriter.hh>
 #include <ewoms/parallel/tasklets.hh>
+#include <ewoms/parallel/threadedentityiterator.hh>
 
 #if HAVE_ECL_OUTPUT
 #include <opm/output/eclipse/EclipseIO.hpp>
@@ -44,6 +45,10 @@
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iostream>
 #include <list>
 #include <utility>
 #include <string>
@@ -52,6 +57,7 @@ namespace Ewoms {
 namespace Properties {
 NEW_PROP_TAG(EnableEclOutput);
 NEW_PROP_TAG(EnableAsyncEclOutput);
+NEW_PROP_TAG(EclOutputMaxQueuedWrites);
 NEW_PROP_TAG(EclOutputDoublePrecision);
 }
 
@@ -98,6 +104,8 @@ public:
     {
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncEclOutput,
                              "Write the ECL-formated results in a non-blocking way (i.e., using a separate thread).");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, EclOutputMaxQueuedWrites,
+                             "The maximum number of report steps which may wait for being written if the ECL output is non-blocking. 0 means unlimited.");
     }
 
     EclWriter(const Simulator& simulator)
@@ -118,11 +126,38 @@ public:
         int numWorkerThreads = 0;
         if (enableAsyncOutput && collectToIORank_.isIORank())
             numWorkerThreads = 1;
-        taskletRunner_.reset(new TaskletRunner(numWorkerThreads));
+        unsigned maxQueuedWrites = EWOMS_GET_PARAM(TypeTag, unsigned, EclOutputMaxQueuedWrites);
+        taskletRunner_.reset(new TaskletRunner(numWorkerThreads, maxQueuedWrites));
     }
 
     ~EclWriter()
-    { }
+    {
+        // wait until all report steps have been written. destructors must not throw,
+        // so errors which have not been reported by finalize() are only printed.
+        try {
+            finalize();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Writing ECL output failed: " << e.what() << "\n" << std::flush;
+        }
+        catch (...) {
+            std::cerr << "Writing ECL output failed\n" << std::flush;
+        }
+    }
+
+    /*!
+     * \brief Wait until all report steps have been written to disk.
+     *
+     * If writing any of them failed, the exception is re-thrown.
+     */
+    void finalize()
+    {
+        while (!pendingWrites_.empty()) {
+            auto writeResult = pendingWrites_.front();
+            pendingWrites_.pop_front();
+            writeResult.get(); // throws if the write failed
+        }
+    }
 
     const Opm::EclipseIO& eclIO() const
     { return *eclIO_; }
@@ -156,15 +191,7 @@ public:
         bool log = collectToIORank_.isIORank();
         eclOutputModule_.allocBuffers(numElements, episodeIdx, isSubStep, log);
 
-        ElementContext elemCtx(simulator_);
-        ElementIterator elemIt = gridView.template begin</*codim=*/0>();
-        const ElementIterator& elemEndIt = gridView.template end</*codim=*/0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
-            const Element& elem = *elemIt;
-            elemCtx.updatePrimaryStencil(elem);
-            elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
-            eclOutputModule_.processElement(elemCtx);
-        }
+        processElements_();
         eclOutputModule_.outputErrorLog();
 
         // collect all data to I/O rank and assign to sol
@@ -196,33 +223,55 @@ public:
                 miscSummaryData["TCPU"] = totalSolverTime;
 
             bool enableDoublePrecisionOutput = EWOMS_GET_PARAM(TypeTag, bool, EclOutputDoublePrecision);
-            const Opm::data::Solution& cellData = collectToIORank_.isParallel() ? collectToIORank_.globalCellData() : localCellData;
-            const Opm::data::Wells& wellData = collectToIORank_.isParallel() ? collectToIORank_.globalWellData() : localWellData;
-
-            const std::map<std::pair<std::string, int>, double>& blockData
-                = collectToIORank_.isParallel()
-                ? collectToIORank_.globalBlockData()
-                : eclOutputModule_.getBlockData();
-
-            // first, create a tasklet to write the data for the current time step to disk
-            auto eclWriteTasklet = std::make_shared<EclWriteTasklet>(*eclIO_,
-                                                                     episodeIdx,
-                                                                     isSubStep,
-                                                                     curTime,
-                                                                     cellData,
-                                                                     wellData,
-                                                                     miscSummaryData,
-                                                                     regionData,
-                                                                     blockData,
-                                                                     extraRestartData,
-                                                                     enableDoublePrecisionOutput);
-
-            // then, make sure that the previous I/O request has been completed and the
-            // number of incomplete tasklets does not increase between time steps
-            taskletRunner_->barrier();
-
-            // finally, start a new output writing job
-            taskletRunner_->dispatch(eclWriteTasklet);
+
+            // first, create a tasklet to write the data for the current time step to
+            // disk. in the parallel case, the data of the other processes is received
+            // by the tasklet. this requires MPI to be usable by multiple threads,
+            // though.
+            std::shared_ptr<EclWriteTasklet> eclWriteTasklet;
+            if (collectToIORank_.isParallel()) {
+                const auto& globalData = collectToIORank_.globalData();
+                if (!CollectDataToIORankType::mayFinishOnOtherThread())
+                    globalData->finish();
+
+                eclWriteTasklet = std::make_shared<EclWriteTasklet>(*eclIO_,
+                                                                    episodeIdx,
+                                                                    isSubStep,
+                                                                    curTime,
+                                                                    globalData,
+                                                                    miscSummaryData,
+                                                                    regionData,
+                                                                    extraRestartData,
+                                                                    enableDoublePrecisionOutput);
+            }
+            else
+                eclWriteTasklet = std::make_shared<EclWriteTasklet>(*eclIO_,
+                                                                    episodeIdx,
+                                                                    isSubStep,
+                                                                    curTime,
+                                                                    localCellData,
+                                                                    localWellData,
+                                                                    miscSummaryData,
+                                                                    regionData,
+                                                                    eclOutputModule_.getBlockData(),
+                                                                    extraRestartData,
+                                                                    enableDoublePrecisionOutput);
+
+            // then, start a new output writing job. the tasklet holds a copy of all data,
+            // so the simulation can continue while the previous report steps are still
+            // being written. if too many report steps are pending, this blocks until the
+            // oldest one has been written.
+            pendingWrites_.push_back(taskletRunner_->dispatch(eclWriteTasklet));
+
+            // finally, report the errors of the report steps which have already been
+            // written. (in synchronous mode, this includes the current one.)
+            while (!pendingWrites_.empty()
+                   && pendingWrites_.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                auto writeResult = pendingWrites_.front();
+                pendingWrites_.pop_front();
+                writeResult.get(); // throws if the write failed
+            }
         }
 #endif
     }
@@ -293,16 +342,16 @@ private:
 #endif
 
         const auto& cartesianCellIdx = globalGrid_.globalCell();
-        const auto* globalTrans = &(simulator_.vanguard().globalTransmissibility());
 
-        if (!collectToIORank_.isParallel())
-            // in the sequential case we must use the transmissibilites defined by
-            // the problem. (because in the sequential case, the grid manager does
-            // not compute "global" transmissibilities for performance reasons. in
-            // the parallel case, the problem's transmissibilities can't be used
-            // because this object refers to the distributed grid and we need the
-            // sequential version here.)
-            globalTrans = &simulator_.problem().eclTransmissibilities();
+        // in the sequential case we must use the transmissibilites defined by the
+        // problem. (because in the sequential case, the grid manager does not compute
+        // "global" transmissibilities for performance reasons. in the parallel case,
+        // the problem's transmissibilities can't be used because this object refers
+        // to the distributed grid and we need the sequential version here.)
+        const auto* globalTrans =
+            collectToIORank_.isParallel()
+            ? &simulator_.vanguard().globalTransmissibility()
+            : &simulator_.problem().eclTransmissibilities();
 
         auto elemIt = globalGridView.template begin</*codim=*/0>();
         const auto& elemEndIt = globalGridView.template end</*codim=*/0>();
@@ -342,6 +391,40 @@ private:
                 {"TRANZ", tranz}};
     }
 
+    // fill the buffers of the output module using all threads of the process. If
+    // they are available, the intensive quantities are taken from the cache of the
+    // model instead of being recomputed.
+    void processElements_()
+    {
+        const auto& model = simulator_.model();
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model.elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // Attention: the variables below are thread specific and thus cannot be
+            // moved in front of the #pragma!
+            ElementContext elemCtx(simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                const Element& elem = *elemIt;
+                elemCtx.updatePrimaryStencil(elem);
+
+                // the output module only deals with the ECFV discretization, i.e., the
+                // element exhibits a single primary degree of freedom
+                unsigned globalDofIdx = elemCtx.globalSpaceIndex(/*spaceIdx=*/0, /*timeIdx=*/0);
+                const auto* cachedIntQuants = model.cachedIntensiveQuantities(globalDofIdx, /*timeIdx=*/0);
+                if (cachedIntQuants) {
+                    eclOutputModule_.processDof(globalDofIdx, *cachedIntQuants);
+                    continue;
+                }
+
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+                eclOutputModule_.processElement(elemCtx);
+            }
+        }
+    }
+
     Opm::NNC exportNncStructure_() const
     {
         Opm::NNC nnc = eclState().getInputNNC();
@@ -359,16 +442,15 @@ private:
         ElementMapper globalElemMapper(globalGridView);
 #endif
 
-        const auto* globalTrans = &(simulator_.vanguard().globalTransmissibility());
-        if (!collectToIORank_.isParallel()) {
-            // in the sequential case we must use the transmissibilites defined by
-            // the problem. (because in the sequential case, the grid manager does
-            // not compute "global" transmissibilities for performance reasons. in
-            // the parallel case, the problem's transmissibilities can't be used
-            // because this object refers to the distributed grid and we need the
-            // sequential version here.)
-            globalTrans = &simulator_.problem().eclTransmissibilities();
-        }
+        // in the sequential case we must use the transmissibilites defined by the
+        // problem. (because in the sequential case, the grid manager does not compute
+        // "global" transmissibilities for performance reasons. in the parallel case,
+        // the problem's transmissibilities can't be used because this object refers
+        // to the distributed grid and we need the sequential version here.)
+        const auto* globalTrans =
+            collectToIORank_.isParallel()
+            ? &simulator_.vanguard().globalTransmissibility()
+            : &simulator_.problem().eclTransmissibilities();
 
         auto elemIt = globalGridView.template begin</*codim=*/0>();
         const auto& elemEndIt = globalGridView.template end</*codim=*/0>();
@@ -420,6 +502,9 @@ private:
         std::map<std::pair<std::string, int>, double> blockSummaryValues_;
         std::map<std::string, std::vector<double>> extraRestartData_;
         bool writeDoublePrecision_;
+        // the data gathered from all processes. if this is set, it is used instead of
+        // the cell, well and block data above
+        std::shared_ptr<typename CollectDataToIORankType::GlobalData> globalData_;
 
         explicit EclWriteTasklet(Opm::EclipseIO& eclIO,
                                  int episodeIdx,
@@ -445,17 +530,41 @@ private:
             , writeDoublePrecision_(writeDoublePrecision)
         { }
 
+        explicit EclWriteTasklet(Opm::EclipseIO& eclIO,
+                                 int episodeIdx,
+                                 bool isSubStep,
+                                 double secondsElapsed,
+                                 std::shared_ptr<typename CollectDataToIORankType::GlobalData> globalData,
+                                 const std::map<std::string, double>& singleSummaryValues,
+                                 const std::map<std::string, std::vector<double>>& regionSummaryValues,
+                                 const std::map<std::string, std::vector<double>>& extraRestartData,
+                                 bool writeDoublePrecision)
+            : eclIO_(eclIO)
+            , episodeIdx_(episodeIdx)
+            , isSubStep_(isSubStep)
+            , secondsElapsed_(secondsElapsed)
+            , singleSummaryValues_(singleSummaryValues)
+            , regionSummaryValues_(regionSummaryValues)
+            , extraRestartData_(extraRestartData)
+            , writeDoublePrecision_(writeDoublePrecision)
+            , globalData_(globalData)
+        { }
+
         // callback to eclIO serial writeTimeStep method
         void run()
         {
+            // wait for the data of the other processes
+            if (globalData_)
+                globalData_->finish();
+
             eclIO_.writeTimeStep(episodeIdx_,
                                  isSubStep_,
                                  secondsElapsed_,
-                                 cellData_,
-                                 wellData_,
+                                 globalData_ ? globalData_->cellData() : cellData_,
+                                 globalData_ ? globalData_->wellData() : wellData_,
                                  singleSummaryValues_,
                                  regionSummaryValues_,
-                                 blockSummaryValues_,
+                                 globalData_ ? globalData_->blockData() : blockSummaryValues_,
                                  extraRestartData_,
                                  writeDoublePrecision_);
         }
@@ -470,6 +579,7 @@ private:
     std::unique_ptr<Opm::EclipseIO> eclIO_;
     Grid globalGrid_;
     std::unique_ptr<TaskletRunner> taskletRunner_;
+    std::deque<std::shared_future<void> > pendingWrites_;
 
 
 };
@@ -56,6 +56,7 @@
 
 #include <array>
 #include <cassert>
+#include <exception>
 #include <utility>
 #include <vector>
 
@@ -664,9 +665,10 @@ phasePressures(const Grid& grid,
  * \tparam CellRange Type of cell range that demarcates the
  *                cells pertaining to the current
  *                equilibration region.  Must implement
- *                methods begin() and end() to bound the range
- *                as well as provide an inner type,
- *                const_iterator, to traverse the range.
+ *                methods begin(), end() and size() to bound the
+ *                range as well as provide an inner type,
+ *                const_iterator, which must be a random access
+ *                iterator.
  *
  * \tparam MaterialLawManager The MaterialLawManager from opm-material
  *
@@ -712,7 +714,6 @@ phaseSaturations(const Grid& grid,
                                          /*storeViscosity=*/false,
                                          /*storeEnthalpy=*/false> SatOnlyFluidState;
 
-    SatOnlyFluidState fluidState;
     typedef typename MaterialLawManager::MaterialLaw MaterialLaw;
 
     const bool water = FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx);
@@ -720,126 +721,150 @@ phaseSaturations(const Grid& grid,
     const int oilpos = FluidSystem::oilPhaseIdx;
     const int waterpos = FluidSystem::waterPhaseIdx;
     const int gaspos = FluidSystem::gasPhaseIdx;
-    std::vector<double>::size_type localIndex = 0;
-    for (typename CellRange::const_iterator ci = cells.begin(); ci != cells.end(); ++ci, ++localIndex) {
-        const int cell = *ci;
-        const auto& scaledDrainageInfo =
-            materialLawManager.oilWaterScaledEpsInfoDrainage(cell);
-        const auto& matParams = materialLawManager.materialLawParams(cell);
-
-        // Find saturations from pressure differences by
-        // inverting capillary pressure functions.
-        double sw = 0.0;
-        if (water) {
-            if (isConstPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,FluidSystem::waterPhaseIdx, cell)){
-                const double cellDepth = Opm::UgGridHelpers::cellCenterDepth(grid,
-                                                                             cell);
-                sw = satFromDepth<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,cellDepth,reg.zwoc(),waterpos,cell,false);
-                phaseSaturations[waterpos][localIndex] = sw;
-            }
-            else {
-                const double pcov = phasePressures[oilpos][localIndex] - phasePressures[waterpos][localIndex];
-                if (swatInit.empty()) { // Invert Pc to find sw
-                    sw = satFromPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, waterpos, cell, pcov);
+    // the cells are independent of each other, so they can be processed in
+    // parallel. since exceptions must not leave the parallel region, the first one
+    // is re-thrown after the loop.
+    const int numCells = static_cast<int>(cells.size());
+    std::exception_ptr exception;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int localIndex = 0; localIndex < numCells; ++localIndex) {
+        try {
+            const int cell = *(cells.begin() + localIndex);
+            SatOnlyFluidState fluidState;
+
+            const auto& scaledDrainageInfo =
+                materialLawManager.oilWaterScaledEpsInfoDrainage(cell);
+            const auto& matParams = materialLawManager.materialLawParams(cell);
+
+            // Find saturations from pressure differences by
+            // inverting capillary pressure functions.
+            double sw = 0.0;
+            if (water) {
+                if (isConstPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,FluidSystem::waterPhaseIdx, cell)){
+                    const double cellDepth = Opm::UgGridHelpers::cellCenterDepth(grid,
+                                                                                 cell);
+                    sw = satFromDepth<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,cellDepth,reg.zwoc(),waterpos,cell,false);
                     phaseSaturations[waterpos][localIndex] = sw;
                 }
-                else { // Scale Pc to reflect imposed sw
-                    sw = swatInit[cell];
-                    sw = materialLawManager.applySwatinit(cell, pcov, sw);
-                    phaseSaturations[waterpos][localIndex] = sw;
+                else {
+                    const double pcov = phasePressures[oilpos][localIndex] - phasePressures[waterpos][localIndex];
+                    if (swatInit.empty()) { // Invert Pc to find sw
+                        sw = satFromPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, waterpos, cell, pcov);
+                        phaseSaturations[waterpos][localIndex] = sw;
+                    }
+                    else { // Scale Pc to reflect imposed sw
+                        sw = swatInit[cell];
+                        sw = materialLawManager.applySwatinit(cell, pcov, sw);
+                        phaseSaturations[waterpos][localIndex] = sw;
+                    }
                 }
             }
-        }
-        double sg = 0.0;
-        if (gas) {
-            if (isConstPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,FluidSystem::gasPhaseIdx,cell)){
-                const double cellDepth = Opm::UgGridHelpers::cellCenterDepth(grid,
-                                                                             cell);
-                sg = satFromDepth<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,cellDepth,reg.zgoc(),gaspos,cell,true);
-                phaseSaturations[gaspos][localIndex] = sg;
+            double sg = 0.0;
+            if (gas) {
+                if (isConstPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,FluidSystem::gasPhaseIdx,cell)){
+                    const double cellDepth = Opm::UgGridHelpers::cellCenterDepth(grid,
+                                                                                 cell);
+                    sg = satFromDepth<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager,cellDepth,reg.zgoc(),gaspos,cell,true);
+                    phaseSaturations[gaspos][localIndex] = sg;
+                }
+                else {
+                    // Note that pcog is defined to be (pg - po), not (po - pg).
+                    const double pcog = phasePressures[gaspos][localIndex] - phasePressures[oilpos][localIndex];
+                    const double increasing = true; // pcog(sg) expected to be increasing function
+                    sg = satFromPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, gaspos, cell, pcog, increasing);
+                    phaseSaturations[gaspos][localIndex] = sg;
+                }
             }
-            else {
-                // Note that pcog is defined to be (pg - po), not (po - pg).
-                const double pcog = phasePressures[gaspos][localIndex] - phasePressures[oilpos][localIndex];
-                const double increasing = true; // pcog(sg) expected to be increasing function
-                sg = satFromPc<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, gaspos, cell, pcog, increasing);
+            if (gas && water && (sg + sw > 1.0)) {
+                // Overlapping gas-oil and oil-water transition
+                // zones can lead to unphysical saturations when
+                // treated as above. Must recalculate using gas-water
+                // capillary pressure.
+                const double pcgw = phasePressures[gaspos][localIndex] - phasePressures[waterpos][localIndex];
+                if (! swatInit.empty()) {
+                    // Re-scale Pc to reflect imposed sw for vanishing oil phase.
+                    // This seems consistent with ecl, and fails to honour
+                    // swatInit in case of non-trivial gas-oil cap pressure.
+                    sw = materialLawManager.applySwatinit(cell, pcgw, sw);
+                }
+                sw = satFromSumOfPcs<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, waterpos, gaspos, cell, pcgw);
+                sg = 1.0 - sw;
+                phaseSaturations[waterpos][localIndex] = sw;
                 phaseSaturations[gaspos][localIndex] = sg;
+                if (water) {
+                    fluidState.setSaturation(FluidSystem::waterPhaseIdx, sw);
+                }
+                else {
+                    fluidState.setSaturation(FluidSystem::waterPhaseIdx, 0.0);
+                }
+                fluidState.setSaturation(FluidSystem::oilPhaseIdx, 1.0 - sw - sg);
+                fluidState.setSaturation(FluidSystem::gasPhaseIdx, sg);
+
+                double pC[/*numPhases=*/3] = { 0.0, 0.0, 0.0 };
+                MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+                double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
+                phasePressures[oilpos][localIndex] = phasePressures[gaspos][localIndex] - pcGas;
             }
-        }
-        if (gas && water && (sg + sw > 1.0)) {
-            // Overlapping gas-oil and oil-water transition
-            // zones can lead to unphysical saturations when
-            // treated as above. Must recalculate using gas-water
-            // capillary pressure.
-            const double pcgw = phasePressures[gaspos][localIndex] - phasePressures[waterpos][localIndex];
-            if (! swatInit.empty()) {
-                // Re-scale Pc to reflect imposed sw for vanishing oil phase.
-                // This seems consistent with ecl, and fails to honour
-                // swatInit in case of non-trivial gas-oil cap pressure.
-                sw = materialLawManager.applySwatinit(cell, pcgw, sw);
-            }
-            sw = satFromSumOfPcs<FluidSystem, MaterialLaw, MaterialLawManager>(materialLawManager, waterpos, gaspos, cell, pcgw);
-            sg = 1.0 - sw;
-            phaseSaturations[waterpos][localIndex] = sw;
-            phaseSaturations[gaspos][localIndex] = sg;
+            phaseSaturations[oilpos][localIndex] = 1.0 - sw - sg;
+
+            // Adjust phase pressures for max and min saturation ...
+            double thresholdSat = 1.0e-6;
+
+            double so = 1.0;
+            double pC[FluidSystem::numPhases] = { 0.0, 0.0, 0.0 };
             if (water) {
-                fluidState.setSaturation(FluidSystem::waterPhaseIdx, sw);
+                double swu = scaledDrainageInfo.Swu;
+                fluidState.setSaturation(FluidSystem::waterPhaseIdx, swu);
+                so -= swu;
             }
-            else {
-                fluidState.setSaturation(FluidSystem::waterPhaseIdx, 0.0);
+            if (gas) {
+                double sgu = scaledDrainageInfo.Sgu;
+                fluidState.setSaturation(FluidSystem::gasPhaseIdx, sgu);
+                so-= sgu;
             }
-            fluidState.setSaturation(FluidSystem::oilPhaseIdx, 1.0 - sw - sg);
-            fluidState.setSaturation(FluidSystem::gasPhaseIdx, sg);
-
-            double pC[/*numPhases=*/3] = { 0.0, 0.0, 0.0 };
-            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
-            double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
-            phasePressures[oilpos][localIndex] = phasePressures[gaspos][localIndex] - pcGas;
-        }
-        phaseSaturations[oilpos][localIndex] = 1.0 - sw - sg;
-
-        // Adjust phase pressures for max and min saturation ...
-        double thresholdSat = 1.0e-6;
+            fluidState.setSaturation(FluidSystem::oilPhaseIdx, so);
 
-        double so = 1.0;
-        double pC[FluidSystem::numPhases] = { 0.0, 0.0, 0.0 };
-        if (water) {
-            double swu = scaledDrainageInfo.Swu;
-            fluidState.setSaturation(FluidSystem::waterPhaseIdx, swu);
-            so -= swu;
-        }
-        if (gas) {
-            double sgu = scaledDrainageInfo.Sgu;
-            fluidState.setSaturation(FluidSystem::gasPhaseIdx, sgu);
-            so-= sgu;
-        }
-        fluidState.setSaturation(FluidSystem::oilPhaseIdx, so);
-
-        if (water && sw > scaledDrainageInfo.Swu-thresholdSat) {
-            fluidState.setSaturation(FluidSystem::waterPhaseIdx, scaledDrainageInfo.Swu);
-            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
-            double pcWat = pC[FluidSystem::oilPhaseIdx] - pC[FluidSystem::waterPhaseIdx];
-            phasePressures[oilpos][localIndex] = phasePressures[waterpos][localIndex] + pcWat;
-        }
-        else if (gas && sg > scaledDrainageInfo.Sgu-thresholdSat) {
-            fluidState.setSaturation(FluidSystem::gasPhaseIdx, scaledDrainageInfo.Sgu);
-            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
-            double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
-            phasePressures[oilpos][localIndex] = phasePressures[gaspos][localIndex] - pcGas;
-        }
-        if (gas && sg < scaledDrainageInfo.Sgl+thresholdSat) {
-            fluidState.setSaturation(FluidSystem::gasPhaseIdx, scaledDrainageInfo.Sgl);
-            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
-            double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
-            phasePressures[gaspos][localIndex] = phasePressures[oilpos][localIndex] + pcGas;
+            if (water && sw > scaledDrainageInfo.Swu-thresholdSat) {
+                fluidState.setSaturation(FluidSystem::waterPhaseIdx, scaledDrainageInfo.Swu);
+                MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+                double pcWat = pC[FluidSystem::oilPhaseIdx] - pC[FluidSystem::waterPhaseIdx];
+                phasePressures[oilpos][localIndex] = phasePressures[waterpos][localIndex] + pcWat;
+            }
+            else if (gas && sg > scaledDrainageInfo.Sgu-thresholdSat) {
+                fluidState.setSaturation(FluidSystem::gasPhaseIdx, scaledDrainageInfo.Sgu);
+                MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+                double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
+                phasePressures[oilpos][localIndex] = phasePressures[gaspos][localIndex] - pcGas;
+            }
+            if (gas && sg < scaledDrainageInfo.Sgl+thresholdSat) {
+                fluidState.setSaturation(FluidSystem::gasPhaseIdx, scaledDrainageInfo.Sgl);
+                MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+                double pcGas = pC[FluidSystem::oilPhaseIdx] + pC[FluidSystem::gasPhaseIdx];
+                phasePressures[gaspos][localIndex] = phasePressures[oilpos][localIndex] + pcGas;
+            }
+            if (water && sw < scaledDrainageInfo.Swl+thresholdSat) {
+                fluidState.setSaturation(FluidSystem::waterPhaseIdx, scaledDrainageInfo.Swl);
+                MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+                double pcWat = pC[FluidSystem::oilPhaseIdx] - pC[FluidSystem::waterPhaseIdx];
+                phasePressures[waterpos][localIndex] = phasePressures[oilpos][localIndex] - pcWat;
+            }
         }
-        if (water && sw < scaledDrainageInfo.Swl+thresholdSat) {
-            fluidState.setSaturation(FluidSystem::waterPhaseIdx, scaledDrainageInfo.Swl);
-            MaterialLaw::capillaryPressures(pC, matParams, fluidState);
-            double pcWat = pC[FluidSystem::oilPhaseIdx] - pC[FluidSystem::waterPhaseIdx];
-            phasePressures[waterpos][localIndex] = phasePressures[oilpos][localIndex] - pcWat;
+        catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            {
+                if (!exception)
+                    exception = std::current_exception();
+            }
         }
     }
+
+    if (exception)
+        std::rethrow_exception(exception);
+
     return phaseSaturations;
 }
 
@@ -1133,35 +1158,76 @@ private:
                           const Grid& grid,
                           const double grav)
     {
+        std::vector<int> regions;
         for (const auto& r : reg.activeRegions()) {
-            const auto& cells = reg.cells(r);
-            if (cells.empty()) {
+            if (reg.cells(r).empty()) {
                 Opm::OpmLog::warning("Equilibration region " + std::to_string(r + 1)
                                      + " has no active cells");
                 continue;
             }
 
-            const EqReg eqreg(rec[r], rsFunc_[r], rvFunc_[r], regionPvtIdx_[r]);
-
-            PVec pressures = phasePressures<FluidSystem>(grid, eqreg, cells, grav);
-            const PVec sat = phaseSaturations<FluidSystem>(grid, eqreg, cells, materialLawManager, swatInit_, pressures);
+            regions.push_back(r);
+        }
 
-            const int np = FluidSystem::numPhases;
-            for (int p = 0; p < np; ++p) {
-                copyFromRegion(pressures[p], cells, pp_[p]);
-                copyFromRegion(sat[p], cells, sat_[p]);
+        // the regions are independent of each other, so they are processed in
+        // parallel if there are several of them. Otherwise, the cells of the only
+        // region are processed in parallel by phaseSaturations(). since exceptions
+        // must not leave the parallel region, the first one is re-thrown after the
+        // loop.
+        const int numRegions = static_cast<int>(regions.size());
+        std::exception_ptr exception;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (numRegions > 1)
+#endif
+        for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+            try {
+                calcRegionPressSatRsRv_(reg, regions[regionIdx], rec, materialLawManager, grid, grav);
             }
-            const bool oil = FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx);
-            const bool gas = FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx);
-            if (oil && gas) {
-                const int oilpos = FluidSystem::oilPhaseIdx;
-                const int gaspos = FluidSystem::gasPhaseIdx;
-                const Vec rsVals = computeRs(grid, cells, pressures[oilpos], temperature_, *(rsFunc_[r]), sat[gaspos]);
-                const Vec rvVals = computeRs(grid, cells, pressures[gaspos], temperature_, *(rvFunc_[r]), sat[oilpos]);
-                copyFromRegion(rsVals, cells, rs_);
-                copyFromRegion(rvVals, cells, rv_);
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!exception)
+                        exception = std::current_exception();
+                }
             }
         }
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    template <class RMap, class MaterialLawManager>
+    void calcRegionPressSatRsRv_(const RMap& reg,
+                                 int r,
+                                 const std::vector< Opm::EquilRecord >& rec,
+                                 MaterialLawManager& materialLawManager,
+                                 const Grid& grid,
+                                 const double grav)
+    {
+        const auto& cells = reg.cells(r);
+
+        const EqReg eqreg(rec[r], rsFunc_[r], rvFunc_[r], regionPvtIdx_[r]);
+
+        PVec pressures = phasePressures<FluidSystem>(grid, eqreg, cells, grav);
+        const PVec sat = phaseSaturations<FluidSystem>(grid, eqreg, cells, materialLawManager, swatInit_, pressures);
+
+        const int np = FluidSystem::numPhases;
+        for (int p = 0; p < np; ++p) {
+            copyFromRegion(pressures[p], cells, pp_[p]);
+            copyFromRegion(sat[p], cells, sat_[p]);
+        }
+        const bool oil = FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx);
+        const bool gas = FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx);
+        if (oil && gas) {
+            const int oilpos = FluidSystem::oilPhaseIdx;
+            const int gaspos = FluidSystem::gasPhaseIdx;
+            const Vec rsVals = computeRs(grid, cells, pressures[oilpos], temperature_, *(rsFunc_[r]), sat[gaspos]);
+            const Vec rvVals = computeRs(grid, cells, pressures[gaspos], temperature_, *(rvFunc_[r]), sat[oilpos]);
+            copyFromRegion(rsVals, cells, rs_);
+            copyFromRegion(rvVals, cells, rv_);
+        }
     }
 
     template <class CellRangeType>
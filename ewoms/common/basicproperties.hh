@@ -118,6 +118,9 @@ NEW_PROP_TAG(RestartTime);
 //! The name of the file with a number of forced time step lengths
 NEW_PROP_TAG(PredeterminedTimeStepsFile);
 
+//! Specify whether restart files are written by a separate thread
+NEW_PROP_TAG(EnableAsyncRestartWriting);
+
 ///////////////////////////////////
 // Values for the properties
 ///////////////////////////////////
@@ -187,6 +190,9 @@ SET_SCALAR_PROP(NumericModel, RestartTime, -1e35);
 //! By default, do not force any time steps
 SET_STRING_PROP(NumericModel, PredeterminedTimeStepsFile, "");
 
+//! By default, restart files are written synchronously
+SET_BOOL_PROP(NumericModel, EnableAsyncRestartWriting, false);
+
 } // namespace Properties
 } // namespace Ewoms
 
@@ -40,7 +40,10 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <set>
 #include <list>
 #include <sstream>
 #include <string>
@@ -99,6 +102,26 @@
     (::Ewoms::Parameters::get<TypeTag, ParamType, PTAG(ParamName)>(#ParamName, \
                                                                    #ParamName))
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter using a handle which caches its value.
+ *
+ * The value of the parameter is resolved when the macro is invoked for the first time
+ * after the parameter registration has been closed. All subsequent invocations only
+ * return the cached value, so this should be used instead of \c EWOMS_GET_PARAM in
+ * performance critical code, e.g. in code which is executed for each element or each
+ * face. Like with \c EWOMS_GET_PARAM, the default value is specified via the property
+ * system. Code which modifies the parameter tree after the cached values have been
+ * retrieved must call Ewoms::Parameters::invalidateCachedParams().
+ *
+ * If the code is compiled with EWOMS_CHECK_HOT_PATH_PARAMS defined, all invocations of
+ * \c EWOMS_GET_PARAM which happen while the global system of equations is linearized
+ * are reported.
+ */
+#define EWOMS_GET_CACHED_PARAM(TypeTag, ParamType, ParamName)                  \
+    (::Ewoms::Parameters::CachedParam<TypeTag, ParamType, PTAG(ParamName)>::get(#ParamName))
+
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
     (::Ewoms::Parameters::get<TypeTag, ParamType, PTAG(ParamName)>(     \
@@ -749,15 +772,126 @@ private:
     }
 };
 
+#ifdef EWOMS_CHECK_HOT_PATH_PARAMS
+// the number of nested code sections in which parameters should not be retrieved
+// without caching. this is read by the worker threads of the linearizer.
+inline std::atomic<int>& hotPathDepth_()
+{
+    static std::atomic<int> depth(0);
+    return depth;
+}
+
+// print a warning the first time a parameter is retrieved without caching while the
+// hot path is active
+inline void checkHotPathLookup_(const char *paramName)
+{
+    if (hotPathDepth_() == 0)
+        return;
+
+#ifdef _OPENMP
+#pragma omp critical (EwomsCheckHotPathParams)
+#endif
+    {
+        static std::set<std::string> reportedParams;
+        if (reportedParams.insert(paramName).second)
+            std::cerr << "Warning: Uncached lookup of parameter '" << paramName << "' "
+                      << "within a performance critical code section. "
+                      << "Consider using EWOMS_GET_CACHED_PARAM.\n" << std::flush;
+    }
+}
+#endif // EWOMS_CHECK_HOT_PATH_PARAMS
+
+/*!
+ * \brief Marks a performance critical section of the code.
+ *
+ * If EWOMS_CHECK_HOT_PATH_PARAMS is defined, all uncached parameter lookups which happen
+ * during the lifetime of objects of this class are reported. Otherwise this class does
+ * nothing. Objects of this class must only be created by the main thread.
+ */
+class HotPathGuard
+{
+public:
+    HotPathGuard()
+    {
+#ifdef EWOMS_CHECK_HOT_PATH_PARAMS
+        ++ hotPathDepth_();
+#endif
+    }
+
+    ~HotPathGuard()
+    {
+#ifdef EWOMS_CHECK_HOT_PATH_PARAMS
+        -- hotPathDepth_();
+#endif
+    }
+};
+
 template <class TypeTag, class ParamType, class PropTag>
 const ParamType get(const char *propTagName, const char *paramName,
                     bool errorIfNotRegistered)
 {
+#ifdef EWOMS_CHECK_HOT_PATH_PARAMS
+    checkHotPathLookup_(paramName);
+#endif
+
     return Param<TypeTag>::template get<ParamType, PropTag>(propTagName,
                                                             paramName,
                                                             errorIfNotRegistered);
 }
 
+// the version of the parameter tree which is seen by the cached parameters
+inline std::atomic<unsigned>& cachedParamGeneration_()
+{
+    static std::atomic<unsigned> generation(1);
+    return generation;
+}
+
+/*!
+ * \brief Make all cached parameters retrieve their values from the parameter tree again.
+ *
+ * This needs to be called if the parameter tree is modified after the values of
+ * cached parameters have been retrieved, e.g., if several simulations with different
+ * parameters are run by the same process. It must not be called while other threads
+ * access cached parameters.
+ */
+inline void invalidateCachedParams()
+{ ++ cachedParamGeneration_(); }
+
+/*!
+ * \brief A handle to a run-time parameter which caches its value.
+ *
+ * The value is retrieved the first time get() is called, which must not happen before
+ * the registration of parameters has been closed, and after each call to
+ * invalidateCachedParams(). Use the EWOMS_GET_CACHED_PARAM macro instead of using this
+ * class directly.
+ */
+template <class TypeTag, class ParamType, class PropTag>
+class CachedParam
+{
+public:
+    static const ParamType& get(const char *paramName)
+    {
+        static std::atomic<unsigned> generation(0);
+        static std::mutex mutex;
+        static ParamType value;
+
+        unsigned currentGeneration = cachedParamGeneration_().load(std::memory_order_acquire);
+        if (generation.load(std::memory_order_acquire) != currentGeneration) {
+            // if the retrieval throws, it will be retried the next time get() is called.
+            std::lock_guard<std::mutex> lock(mutex);
+            if (generation.load(std::memory_order_relaxed) != currentGeneration) {
+                value =
+                    Param<TypeTag>::template get<ParamType, PropTag>(/*propTagName=*/paramName,
+                                                                     paramName,
+                                                                     /*errorIfNotRegistered=*/true);
+                generation.store(currentGeneration, std::memory_order_release);
+            }
+        }
+
+        return value;
+    }
+};
+
 template <class TypeTag, class ParamType, class PropTag>
 void registerParam(const char *paramName, const char *propertyName, const char *usageString)
 {
@@ -800,6 +934,7 @@ void endParamRegistration()
                                "to close it once.");
 
     ParamsMeta::registrationOpen() = false;
+    invalidateCachedParams();
 
     // loop over all parameters and retrieve their values to make sure
     // that there is no syntax error
@@ -29,6 +29,7 @@
 #define EWOMS_SIMULATOR_HH
 
 #include <ewoms/io/restart.hh>
+#include <ewoms/parallel/tasklets.hh>
 #include <ewoms/common/parametersystem.hh>
 
 #include <ewoms/common/propertysystem.hh>
@@ -56,6 +57,7 @@ NEW_PROP_TAG(EndTime);
 NEW_PROP_TAG(RestartTime);
 NEW_PROP_TAG(InitialTimeStepSize);
 NEW_PROP_TAG(PredeterminedTimeStepsFile);
+NEW_PROP_TAG(EnableAsyncRestartWriting);
 }
 
 /*!
@@ -114,6 +116,9 @@ public:
 
         finished_ = false;
 
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncRestartWriting))
+            restartTaskletRunner_.reset(new TaskletRunner(/*numWorkers=*/1));
+
         if (verbose_)
             std::cout << "Instantiating the vanguard\n" << std::flush;
         vanguard_.reset(new Vanguard(*this));
@@ -158,6 +163,8 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, std::string, PredeterminedTimeStepsFile,
                              "A file with a list of predetermined time step sizes (one "
                              "time step per line)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncRestartWriting,
+                             "Write restart files using a separate thread");
 
         Vanguard::registerParameters();
         Model::registerParameters();
@@ -694,6 +701,10 @@ public:
         }
         executionTimer_.stop();
 
+        // make sure that the last restart file has been written successfully
+        if (restartTaskletRunner_)
+            restartTaskletRunner_->barrier();
+
         problem_->finalize();
     }
 
@@ -789,8 +800,13 @@ public:
      */
     void serialize()
     {
+        // report the errors of the previously written restart files
+        if (restartTaskletRunner_)
+            restartTaskletRunner_->barrier();
+
         typedef Ewoms::Restart Restarter;
         Restarter res;
+        res.setTaskletRunner(restartTaskletRunner_.get());
         res.serializeBegin(*this);
         if (gridView().comm().rank() == 0)
             std::cout << "Serialize to file '" << res.fileName() << "'"
@@ -872,6 +888,11 @@ private:
 
     bool finished_;
     bool verbose_;
+
+    // writes the restart files if this is done asynchronously. this needs to be the
+    // last attribute so that all pending restart files are written before the rest of
+    // the simulator is destroyed
+    std::unique_ptr<TaskletRunner> restartTaskletRunner_;
 };
 } // namespace Ewoms
 
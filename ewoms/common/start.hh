@@ -166,6 +166,9 @@ static inline int setupParameters_(int argc, const char **argv, bool registerPar
                                                /*overwrite=*/false);
     }
 
+    // the parameter tree may have changed since the cached parameters were retrieved
+    Parameters::invalidateCachedParams();
+
     return /*status=*/0;
 }
 
@@ -177,7 +177,7 @@ public:
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
         elemCtx.updateStencil(elem);
-        elemCtx.updateAllIntensiveQuantities();
+        elemCtx.updateLinearizationIntensiveQuantities();
 
         // update the weights of the primary variables for the context
         model_().updatePVWeights(elemCtx);
@@ -42,12 +42,14 @@
 #include "fvbasediscretization.hh"
 #include "fvbasegradientcalculator.hh"
 #include "fvbasenewtonmethod.hh"
+#include "fvbasetimestepcontroller.hh"
 #include "fvbaseprimaryvariables.hh"
 #include "fvbaseintensivequantities.hh"
 #include "fvbaseextensivequantities.hh"
 
 #include <ewoms/parallel/gridcommhandles.hh>
 #include <ewoms/parallel/threadmanager.hh>
+#include <ewoms/parallel/entitychunks.hh>
 #include <ewoms/linear/nullborderlistmanager.hh>
 #include <ewoms/common/simulator.hh>
 #include <ewoms/aux/baseauxiliarymodule.hh>
@@ -76,6 +78,7 @@
 #endif
 
 #include <limits>
+#include <type_traits>
 #include <list>
 #include <sstream>
 #include <string>
@@ -139,6 +142,24 @@ public:
 //! Newton solver
 SET_INT_PROP(FvBaseDiscretization, MaxTimeStepDivisions, 10);
 
+//! By default, use the generic time step controller
+SET_TYPE_PROP(FvBaseDiscretization, TimeStepController, Ewoms::FvBaseTimeStepController<TypeTag>);
+
+//! Determine the size of time steps by the number of Newton iterations by default
+SET_STRING_PROP(FvBaseDiscretization, TimeStepControl, "iterationcount");
+
+//! Aim for a maximum change of 10% if the PID time step control is used
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlTolerance, 0.1);
+
+//! Do not allow the time step size to more than triple with the PID time step control
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlMaxGrowth, 3.0);
+
+//! By default, failed time steps do not limit the size of the next ones
+SET_INT_PROP(FvBaseDiscretization, TimeStepFailureMemory, 0);
+
+//! Retry failed time steps from the solution of the last time step by default
+SET_BOOL_PROP(FvBaseDiscretization, RestartFailedTimeStepFromLastIterate, false);
+
 /*!
  * \brief A vector of quanties, each for one equation.
  */
@@ -208,6 +229,9 @@ SET_TYPE_PROP(FvBaseDiscretization, ConstraintsContext, Ewoms::FvBaseConstraints
 SET_TYPE_PROP(FvBaseDiscretization, ThreadManager, Ewoms::ThreadManager<TypeTag>);
 SET_INT_PROP(FvBaseDiscretization, ThreadsPerProcess, 1);
 SET_BOOL_PROP(FvBaseDiscretization, UseLinearizationLock, true);
+SET_BOOL_PROP(FvBaseDiscretization, EnableColoredLinearization, true);
+SET_BOOL_PROP(FvBaseDiscretization, EnableIntensiveQuantityPrecomputation, true);
+SET_BOOL_PROP(FvBaseDiscretization, EnableWorkStealing, true);
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -235,6 +259,9 @@ SET_BOOL_PROP(FvBaseDiscretization, EnableVtkOutput, true);
 //! This has only an effect if EnableVtkOutput is true
 SET_BOOL_PROP(FvBaseDiscretization, EnableAsyncVtkOutput, true);
 
+//! Allow two VTK data sets to wait for being written to disk
+SET_INT_PROP(FvBaseDiscretization, VtkOutputMaxQueuedWrites, 2);
+
 //! Set the format of the VTK output to ASCII by default
 SET_INT_PROP(FvBaseDiscretization, VtkOutputFormat, Dune::VTK::ascii);
 
@@ -320,6 +347,7 @@ class FvBaseDiscretization
 
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef Ewoms::EntityChunks<GridView, /*codim=*/0> ElementChunks;
 
     typedef Opm::MathToolbox<Evaluation> Toolbox;
     typedef Dune::FieldVector<Evaluation, numEq> VectorBlock;
@@ -391,7 +419,11 @@ public:
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , retainFailedIterate_(false)
+        , failedIterateValid_(false)
     {
+        elementChunks_.setEnableWorkStealing(EWOMS_GET_PARAM(TypeTag, bool, EnableWorkStealing));
+
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
             throw std::invalid_argument("Grid adaptation enabled, but chosen Grid is not capable"
@@ -413,7 +445,7 @@ public:
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
 
-            if (storeIntensiveQuantities()) {
+            if (storeIntensiveQuantities() && !historyIntensiveQuantitiesUnused_(timeIdx)) {
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
             }
@@ -458,6 +490,7 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableWorkStealing, "Allow threads which are done with their share of the grid's elements to work on the elements assigned to other threads");
     }
 
     /*!
@@ -602,6 +635,17 @@ public:
         // do nothing by default
     }
 
+    /*!
+     * \brief Prepare a stencil object before it is used for the first time.
+     *
+     * This is called by the constructor of the element context and allows the
+     * discretization to, e.g., share precomputed geometric information.
+     */
+    void initStencil(Stencil& stencil OPM_UNUSED) const
+    {
+        // do nothing by default
+    }
+
     /*!
      * \brief Returns the newton method object
      */
@@ -651,21 +695,24 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ ||
-            !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
-            return 0;
-
-        if (timeIdx > 0 && enableStorageCache_)
+        if (historyIntensiveQuantitiesUnused_(timeIdx))
             // with the storage cache enabled, only the intensive quantities for the most
             // recent time step are cached!
             return 0;
 
+        if (!enableIntensiveQuantityCache_ ||
+            !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+            return 0;
+
         return &intensiveQuantityCache_[timeIdx][globalIdx];
     }
 
     /*!
      * \brief Update the intensive quantity cache for a entity on the grid at given time.
      *
+     * This method may be called concurrently by multiple threads as long as they
+     * update the cache entries of distinct degrees of freedom.
+     *
      * \param intQuants The IntensiveQuantities object hint for a given degree of freedom.
      * \param globalIdx The global space index for the entity where a
      *                  hint is to be set.
@@ -675,7 +722,7 @@ public:
                                          unsigned globalIdx,
                                          unsigned timeIdx) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || historyIntensiveQuantitiesUnused_(timeIdx))
             return;
 
         intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
@@ -685,6 +732,9 @@ public:
     /*!
      * \brief Invalidate the cache for a given intensive quantities object.
      *
+     * Like updateCachedIntensiveQuantities(), this may be called concurrently for
+     * distinct degrees of freedom.
+     *
      * \param globalIdx The global space index for the entity where a
      *                  hint is to be set.
      * \param timeIdx The index used by the time discretization.
@@ -693,7 +743,7 @@ public:
                                                   unsigned timeIdx,
                                                   bool newValue) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || historyIntensiveQuantitiesUnused_(timeIdx))
             return;
 
         intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue;
@@ -815,7 +865,7 @@ public:
         dest = 0;
 
         OmpMutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -876,7 +926,7 @@ public:
         storage = 0;
 
         OmpMutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1319,6 +1369,42 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Specify whether the last iterate of a failed update should be kept.
+     *
+     * If this is enabled, restoreFailedIterate() can be used to start the next update
+     * at the last iterate of a failed Newton method instead of the solution of the
+     * previous time step.
+     */
+    void setRetainFailedIterate(bool yesno)
+    {
+        retainFailedIterate_ = yesno;
+        if (!yesno) {
+            failedIterateValid_ = false;
+            SolutionVector().swap(failedIterate_);
+        }
+    }
+
+    /*!
+     * \brief Use the last iterate of the most recent failed update as the current
+     *        solution.
+     *
+     * This method returns false and does not do anything if no such iterate is
+     * available. (i.e., if retaining the failed iterates is disabled or if the Newton
+     * method did not reduce the error during the failed update.)
+     */
+    bool restoreFailedIterate()
+    {
+        if (!failedIterateValid_)
+            return false;
+
+        solution(/*timeIdx=*/0) = failedIterate_;
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        failedIterateValid_ = false;
+
+        return true;
+    }
+
     /*!
      * \brief Called by the update() method if it was
      *        unsuccessful. This is primary a hook which the actual
@@ -1326,6 +1412,12 @@ public:
      */
     void updateFailed()
     {
+        // keep the last iterate if it is requested and if the Newton method made
+        // some progress towards the solution.
+        failedIterateValid_ = retainFailedIterate_ && newtonMethod_.lastIterateUsable();
+        if (failedIterateValid_)
+            failedIterate_ = solution(/*timeIdx=*/0);
+
         // Reset the current solution to the one of the
         // previous time step so that we can start the next
         // update at a physically meaningful solution.
@@ -1632,7 +1724,7 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1680,6 +1772,22 @@ public:
     const GridView& gridView() const
     { return gridView_; }
 
+    /*!
+     * \brief Returns the partition of the grid's elements which ought to be used for
+     *        thread-parallel loops over all elements.
+     *
+     * The partition is only re-created if the grid has changed since it was used last.
+     * This method must be called from a sequential context.
+     */
+    const ElementChunks& elementChunks() const
+    {
+        int curSeqNum = simulator_.vanguard().gridSequenceNumber();
+        if (!elementChunks_.isUpToDate(curSeqNum))
+            elementChunks_.update(gridView_, ThreadManager::maxThreads(), curSeqNum);
+
+        return elementChunks_;
+    }
+
     /*!
      * \brief Add a module for an auxiliary equation.
      *
@@ -1776,6 +1884,69 @@ public:
     { return updateTimer_; }
 
 protected:
+    /*!
+     * \brief Write the solution for all DOFs of the grid to a restart file.
+     *
+     * If the primary variables are trivially copyable, the solution is written as a
+     * raw array. Otherwise, the serializeEntity() method is called for each DOF
+     * entity.
+     */
+    template <int dofCodim, class Restarter>
+    void serializeSolution_(Restarter& res)
+    {
+        typedef std::is_trivially_copyable<PrimaryVariables> IsRaw;
+        serializeSolution_<dofCodim>(res, IsRaw());
+    }
+
+    template <int dofCodim, class Restarter>
+    void serializeSolution_(Restarter& res, std::true_type)
+    {
+        const auto& sol = solution(/*timeIdx=*/0);
+        size_t n = asImp_().numGridDof();
+        res.serializeArray("Solution", (n > 0)?&sol[0]:nullptr, n);
+    }
+
+    template <int dofCodim, class Restarter>
+    void serializeSolution_(Restarter& res, std::false_type)
+    { res.template serializeEntities<dofCodim>(asImp_(), gridView_); }
+
+    /*!
+     * \brief Read the solution for all DOFs of the grid from a restart file.
+     *
+     * This is the inverse of serializeSolution_().
+     */
+    template <int dofCodim, class Restarter>
+    void deserializeSolution_(Restarter& res)
+    {
+        typedef std::is_trivially_copyable<PrimaryVariables> IsRaw;
+        deserializeSolution_<dofCodim>(res, IsRaw());
+    }
+
+    template <int dofCodim, class Restarter>
+    void deserializeSolution_(Restarter& res, std::true_type)
+    {
+        // text based restart files store the solution per entity
+        if (res.isLegacyFormat()) {
+            deserializeSolution_<dofCodim>(res, std::false_type());
+            return;
+        }
+
+        auto& sol = solution(/*timeIdx=*/0);
+        size_t n = asImp_().numGridDof();
+        res.deserializeArray("Solution", (n > 0)?&sol[0]:nullptr, n);
+    }
+
+    template <int dofCodim, class Restarter>
+    void deserializeSolution_(Restarter& res, std::false_type)
+    { res.template deserializeEntities<dofCodim>(asImp_(), gridView_); }
+
+    // returns true if the cached intensive quantities of a given time index are never
+    // accessed. if the storage cache is enabled, the storage terms of the previous time
+    // steps are cached instead, so the intensive quantities of these time indices do not
+    // need to be stored at all.
+    bool historyIntensiveQuantitiesUnused_(unsigned timeIdx) const
+    { return timeIdx > 0 && enableStorageCache_; }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
         // allocate the storage cache
@@ -1790,6 +1961,9 @@ protected:
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
             for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx) {
+                if (historyIntensiveQuantitiesUnused_(timeIdx))
+                    continue;
+
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
                 invalidateIntensiveQuantitiesCache(timeIdx);
@@ -1845,6 +2019,9 @@ protected:
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
 
+    // the assignment of the elements to the threads
+    mutable ElementChunks elementChunks_;
+
     // a vector with all auxiliary equations to be considered
     std::vector<std::shared_ptr<BaseAuxiliaryModule<TypeTag> > > auxEqModules_;
 
@@ -1864,7 +2041,9 @@ protected:
     // cur is the current iterative solution, prev the converged
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    mutable std::vector<bool> intensiveQuantityCacheUpToDate_[historySize];
+    // the validity of the cache entries is stored as bytes instead of bits, so that
+    // different threads can update the entries of different DOFs concurrently
+    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
 
     DiscreteFunctionSpace space_;
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
@@ -1887,6 +2066,11 @@ protected:
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+
+    // the last iterate of the most recent failed update
+    bool retainFailedIterate_;
+    bool failedIterateValid_;
+    SolutionVector failedIterate_;
 };
 } // namespace Ewoms
 
@@ -100,6 +100,8 @@ public:
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+
+        simulator.model().initStencil(stencil_);
     }
 
     static void *operator new(size_t size) {
@@ -196,6 +198,27 @@ public:
             asImp_().updateIntensiveQuantities(/*timeIdx=*/0);
     }
 
+    /*!
+     * \brief Compute the intensive quantities which are required to linearize the local
+     *        residual of the current element.
+     *
+     * In contrast to updateAllIntensiveQuantities(), the intensive quantities for the
+     * previous points of history are only calculated for the primary degrees of
+     * freedom: They are only required by the storage term, which is never evaluated for
+     * the secondary degrees of freedom. For the element centered finite volume method,
+     * this avoids updating the intensive quantities of all neighbors of an element for
+     * the beginning of the time step.
+     */
+    void updateLinearizationIntensiveQuantities()
+    {
+        asImp_().updateIntensiveQuantities(/*timeIdx=*/0);
+
+        if (!enableStorageCache_) {
+            for (unsigned timeIdx = 1; timeIdx < timeDiscHistorySize; ++ timeIdx)
+                asImp_().updatePrimaryIntensiveQuantities(timeIdx);
+        }
+    }
+
     /*!
      * \brief Compute the intensive quantities of all sub-control volumes of the current
      *        element for a single time index.
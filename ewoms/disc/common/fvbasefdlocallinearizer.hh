@@ -227,7 +227,9 @@ public:
      */
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
-        elemCtx.updateAll(elem);
+        elemCtx.updateStencil(elem);
+        elemCtx.updateLinearizationIntensiveQuantities();
+        elemCtx.updateAllExtensiveQuantities();
 
         // update the weights of the primary variables for the context
         model_().updatePVWeights(elemCtx);
@@ -328,7 +330,7 @@ protected:
      * \brief Returns the numeric difference method which is applied.
      */
     static int numericDifferenceMethod_()
-    { return EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NumericDifferenceMethod); }
 
     /*!
      * \brief Resize all internal attributes to the size of the
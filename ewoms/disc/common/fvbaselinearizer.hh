@@ -30,6 +30,7 @@
 
 #include "fvbaseproperties.hh"
 
+#include <ewoms/common/parametersystem.hh>
 #include <ewoms/parallel/gridcommhandles.hh>
 #include <ewoms/parallel/threadmanager.hh>
 #include <ewoms/parallel/threadedentityiterator.hh>
@@ -42,6 +43,8 @@
 #include <dune/common/fmatrix.hh>
 
 #include <type_traits>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <set>
@@ -101,6 +104,18 @@ class FvBaseLinearizer
 
     static const bool linearizeNonLocalElements = GET_PROP_VALUE(TypeTag, LinearizeNonLocalElements);
 
+    // the number of consecutive elements which are colored as a single unit. using
+    // chunks instead of individual elements keeps the memory required to store the
+    // coloring small and it preserves the locality of the element iteration.
+    static const unsigned coloringChunkSize_ = 32;
+
+    // a range of consecutive elements of the grid view
+    struct ElementChunk
+    {
+        ElementIterator begin;
+        unsigned size;
+    };
+
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
 //! \endcond
@@ -111,6 +126,10 @@ public:
         simulatorPtr_ = 0;
 
         matrix_ = 0;
+
+        enableColoring_ = false;
+        coloringSequenceNumber_ = -1;
+        enableIntensiveQuantityPrecomputation_ = false;
     }
 
     ~FvBaseLinearizer()
@@ -126,7 +145,14 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableColoredLinearization,
+                             "Use a coloring of the grid's elements instead of a lock to avoid "
+                             "race conditions when linearizing using multiple threads");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityPrecomputation,
+                             "Update the cached intensive quantities of all degrees of "
+                             "freedom before linearizing the elements");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -142,6 +168,17 @@ public:
         simulatorPtr_ = &simulator;
         delete matrix_; // <- note that this even works for nullpointers!
         matrix_ = 0;
+
+        enableColoring_ =
+            GET_PROP_VALUE(TypeTag, UseLinearizationLock)
+            && ThreadManager::maxThreads() > 1
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableColoredLinearization);
+        enableIntensiveQuantityPrecomputation_ =
+            !GET_PROP_VALUE(TypeTag, UseLinearizationLock)
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache)
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityPrecomputation);
+        chunksByColor_.clear();
+        coloringSequenceNumber_ = -1;
     }
 
     /*!
@@ -155,6 +192,9 @@ public:
     {
         delete matrix_; // <- note that this even works for nullpointers!
         matrix_ = 0;
+
+        chunksByColor_.clear();
+        coloringSequenceNumber_ = -1;
     }
 
     /*!
@@ -329,6 +369,65 @@ private:
         matrix_->endindices();
     }
 
+    // partition the elements into chunks of consecutive elements and color them such
+    // that no two chunks of the same color exhibit a common primary degree of
+    // freedom. Since the linearization of an element only writes to the rows of the
+    // residual and the columns of the Jacobian which belong to its primary degrees of
+    // freedom, the chunks of a given color can then be linearized concurrently without
+    // any locking. The coloring only needs to be recomputed if the grid changes.
+    void updateColoring_()
+    {
+        int curSeqNum = simulator_().vanguard().gridSequenceNumber();
+        if (coloringSequenceNumber_ == curSeqNum && !chunksByColor_.empty())
+            return;
+
+        coloringSequenceNumber_ = curSeqNum;
+        chunksByColor_.clear();
+
+        Stencil stencil(gridView_(), dofMapper_());
+
+        // the colors of all chunks which have already been assigned and which exhibit a
+        // given degree of freedom
+        std::vector<std::vector<unsigned> > dofColors(model_().numTotalDof());
+        std::vector<unsigned> chunkDofs;
+        std::vector<bool> colorIsUsed;
+
+        ElementIterator elemIt = gridView_().template begin</*codim=*/0>();
+        const ElementIterator elemEndIt = gridView_().template end</*codim=*/0>();
+        while (elemIt != elemEndIt) {
+            ElementChunk chunk = { elemIt, /*size=*/0 };
+
+            chunkDofs.clear();
+            for (; elemIt != elemEndIt && chunk.size < coloringChunkSize_; ++elemIt, ++chunk.size) {
+                stencil.update(*elemIt);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                    chunkDofs.push_back(stencil.globalSpaceIndex(primaryDofIdx));
+            }
+
+            // find the smallest color which is not yet used by any neighboring chunk
+            std::fill(colorIsUsed.begin(), colorIsUsed.end(), false);
+            for (unsigned globI : chunkDofs)
+                for (unsigned color : dofColors[globI])
+                    colorIsUsed[color] = true;
+
+            unsigned chunkColor = 0;
+            while (chunkColor < colorIsUsed.size() && colorIsUsed[chunkColor])
+                ++chunkColor;
+
+            if (chunkColor == chunksByColor_.size()) {
+                chunksByColor_.emplace_back();
+                colorIsUsed.push_back(false);
+            }
+
+            chunksByColor_[chunkColor].push_back(chunk);
+            for (unsigned globI : chunkDofs) {
+                auto& colors = dofColors[globI];
+                if (std::find(colors.begin(), colors.end(), chunkColor) == colors.end())
+                    colors.push_back(chunkColor);
+            }
+        }
+    }
+
     // reset the global linear system of equations.
     void resetSystem_()
     {
@@ -347,7 +446,7 @@ private:
         constraintsMap_.clear();
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model_().elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -385,6 +484,9 @@ private:
     // linearize the whole system
     void linearize_()
     {
+        // parameters should not be looked up without caching during the linearization
+        Parameters::HotPathGuard hotPathGuard;
+
         resetSystem_();
 
         // before the first iteration of each time step, we need to update the
@@ -395,10 +497,60 @@ private:
 
         applyConstraintsToSolution_();
 
+        if (enableIntensiveQuantityPrecomputation_)
+            precomputeIntensiveQuantities_();
+
         *matrix_ = 0.0;
 
+        if (enableColoring_)
+            linearizeColored_();
+        else
+            linearizeLocked_();
+
+        applyConstraintsToLinearization_();
+
+        linearizeAuxiliaryEquations_();
+    }
+
+    // update the cached intensive quantities of all degrees of freedom for the current
+    // iterative solution. since this is only done if every DOF is the primary DOF of a
+    // single element, each cache entry is written by exactly one thread. the
+    // linearization of the elements afterwards only reads from the cache, whereas the
+    // intensive quantities of the neighbors would otherwise be computed (and be written
+    // to the cache) by all threads which linearize an element of their stencils.
+    void precomputeIntensiveQuantities_()
+    {
+        const auto& model = model_();
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model.elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext& elemCtx = *elementCtx_[threadId];
+
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                // the non-local elements are also considered because their intensive
+                // quantities are required by the stencils of the local ones
+                const Element& elem = *elemIt;
+                elemCtx.updatePrimaryStencil(elem);
+
+                unsigned globalIdx = elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0);
+                if (model.cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0))
+                    continue;
+
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            }
+        }
+    }
+
+    // linearize all elements and use the global lock to prevent concurrent writes to the
+    // global linear system of equations if this is required by the discretization
+    void linearizeLocked_()
+    {
         // relinearize the elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model_().elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -423,17 +575,54 @@ private:
                 if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                     continue;
 
-                linearizeElement_(elem);
+                linearizeElement_(elem, GET_PROP_VALUE(TypeTag, UseLinearizationLock));
             }
         }
+    }
 
-        applyConstraintsToLinearization_();
+    // linearize all elements color by color. this does not require any locking because
+    // the chunks of a color never write to the same entries of the global linear system.
+    void linearizeColored_()
+    {
+        updateColoring_();
 
-        linearizeAuxiliaryEquations_();
+        for (const auto& colorChunks : chunksByColor_) {
+            int numChunks = static_cast<int>(colorChunks.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+            for (int chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+                const ElementChunk& chunk = colorChunks[static_cast<unsigned>(chunkIdx)];
+
+                ElementIterator elemIt = chunk.begin;
+                for (unsigned i = 0; i < chunk.size; ++i) {
+                    ElementIterator nextElemIt = elemIt;
+                    ++nextElemIt;
+
+                    // give the model and the problem a chance to prefetch the data
+                    // required to linearize the next element of the chunk
+                    if (i + 1 < chunk.size) {
+                        const auto& nextElem = *nextElemIt;
+                        if (linearizeNonLocalElements
+                            || nextElem.partitionType() == Dune::InteriorEntity)
+                        {
+                            model_().prefetch(nextElem);
+                            problem_().prefetch(nextElem);
+                        }
+                    }
+
+                    const Element& elem = *elemIt;
+                    if (linearizeNonLocalElements || elem.partitionType() == Dune::InteriorEntity)
+                        linearizeElement_(elem, /*useLock=*/false);
+
+                    elemIt = nextElemIt;
+                }
+            }
+        }
     }
 
     // linearize an element in the interior of the process' grid partition
-    void linearizeElement_(const Element& elem)
+    void linearizeElement_(const Element& elem, bool useLock)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -444,7 +633,7 @@ private:
         localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
-        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+        if (useLock)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
@@ -462,7 +651,7 @@ private:
             }
         }
 
-        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+        if (useLock)
             globalMatrixMutex_.unlock();
     }
 
@@ -536,9 +725,15 @@ private:
     Matrix *matrix_;
     // the right-hand side
     GlobalEqVector residual_;
-
+    // the maximum weighted residual of the local grid DOFs
 
     OmpMutex globalMatrixMutex_;
+
+    // the chunks of elements of each color if colored linearization is used
+    bool enableColoring_;
+    std::vector<std::vector<ElementChunk> > chunksByColor_;
+    int coloringSequenceNumber_;
+    bool enableIntensiveQuantityPrecomputation_;
 };
 
 } // namespace Ewoms
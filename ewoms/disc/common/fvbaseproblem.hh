@@ -32,6 +32,7 @@
 
 #include <ewoms/io/vtkmultiwriter.hh>
 #include <ewoms/io/restart.hh>
+#include <ewoms/common/timer.hh>
 #include <ewoms/disc/common/restrictprolong.hh>
 
 #include <opm/material/common/Unused.hpp>
@@ -69,6 +70,7 @@ private:
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
     typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
     typedef typename GET_PROP_TYPE(TypeTag, NewtonMethod) NewtonMethod;
+    typedef typename GET_PROP_TYPE(TypeTag, TimeStepController) TimeStepController;
 
     typedef typename GET_PROP_TYPE(TypeTag, VertexMapper) VertexMapper;
     typedef typename GET_PROP_TYPE(TypeTag, ElementMapper) ElementMapper;
@@ -119,6 +121,7 @@ public:
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
         , defaultVtkWriter_(0)
+        , timeStepController_(simulator)
     {
         // calculate the bounding box of the local partition of the grid view
         VertexIterator vIt = gridView_.template begin<dim>();
@@ -137,10 +140,13 @@ public:
         }
 
         if (enableVtkOutput_()) {
-            bool asyncVtkOutput =
-                simulator_.gridView().comm().size() == 1 &&
-                EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncVtkOutput);
-            defaultVtkWriter_ = new VtkMultiWriter(asyncVtkOutput, gridView_, asImp_().name());
+            bool asyncVtkOutput = EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncVtkOutput);
+            unsigned maxQueuedWrites = EWOMS_GET_PARAM(TypeTag, unsigned, VtkOutputMaxQueuedWrites);
+            defaultVtkWriter_ = new VtkMultiWriter(asyncVtkOutput,
+                                                   gridView_,
+                                                   asImp_().name(),
+                                                   /*multiFileName=*/"",
+                                                   maxQueuedWrites);
         }
     }
 
@@ -161,8 +167,13 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, unsigned, MaxTimeStepDivisions,
                              "The maximum number of divisions by two of the timestep size "
                              "before the simulation bails out");
+        TimeStepController::registerParameters();
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncVtkOutput,
                              "Dispatch a separate thread to write the VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, VtkOutputMaxQueuedWrites,
+                             "The maximum number of VTK data sets which may wait for being "
+                             "written to disk if the output is written asynchronously. 0 "
+                             "means unlimited");
     }
 
     /*!
@@ -355,6 +366,8 @@ public:
         Scalar linearizeTime = simulator().linearizeTimer().realTimeElapsed();
         Scalar solveTime = simulator().solveTimer().realTimeElapsed();
         Scalar updateTime = simulator().updateTimer().realTimeElapsed();
+        Scalar wastedTime = timeStepController_.wastedTime();
+        unsigned numFailedAttempts = timeStepController_.numFailedAttempts();
         unsigned numProcesses = static_cast<unsigned>(this->gridView().comm().size());
         unsigned threadsPerProcess = ThreadManager::maxThreads();
         if (gridView().comm().rank() == 0) {
@@ -376,6 +389,9 @@ public:
                       << ", " << prePostProcessTime/executionTime*100 << "%\n"
                       << "    Output write time: "  << writeTime << " seconds" << Simulator::humanReadableTime(writeTime)
                       << ", " << writeTime/executionTime*100 << "%\n"
+                      << "    Time spent on " << numFailedAttempts << " failed time step attempts: "
+                      << wastedTime << " seconds" << Simulator::humanReadableTime(wastedTime)
+                      << ", " << wastedTime/executionTime*100 << "%\n"
                       << "First process' simulation CPU time: "  << localCpuTime << " seconds" <<  Simulator::humanReadableTime(localCpuTime) << "\n"
                       << "Number of processes: " << numProcesses << "\n"
                       << "Threads per processes: " << threadsPerProcess << "\n"
@@ -412,17 +428,30 @@ public:
             simulator().setTimeStepSize(minTimeStepSize);
         }
 
+        bool retryFromLastIterate = timeStepController_.retryFromLastIterate();
+        model().setRetainFailedIterate(retryFromLastIterate);
+
         for (unsigned i = 0; i < maxFails; ++i) {
+            Ewoms::Timer attemptTimer;
+            attemptTimer.start();
             bool converged = model().update();
-            if (converged)
+            Scalar attemptTime = attemptTimer.stop();
+            if (converged) {
+                timeStepController_.attemptSucceeded();
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
-            Scalar nextDt = dt / 2;
+            timeStepController_.attemptFailed(dt, attemptTime);
+
+            Scalar nextDt = timeStepController_.retryTimeStepSize(dt);
             if (nextDt < minTimeStepSize)
                 break; // give up: we can't make the time step smaller anymore!
             simulator().setTimeStepSize(nextDt);
 
+            if (retryFromLastIterate)
+                model().restoreFailedIterate();
+
             // update failed
             if (gridView().comm().rank() == 0)
                 std::cout << "Newton solver did not converge with "
@@ -443,7 +472,7 @@ public:
     Scalar nextTimeStepSize()
     {
         Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+                                 timeStepController_.nextTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -656,6 +685,18 @@ public:
     VtkMultiWriter& defaultVtkWriter() const
     { return defaultVtkWriter_; }
 
+    /*!
+     * \brief Returns the object which decides about the size of the time steps.
+     */
+    TimeStepController& timeStepController()
+    { return timeStepController_; }
+
+    /*!
+     * \copydoc timeStepController()
+     */
+    const TimeStepController& timeStepController() const
+    { return timeStepController_; }
+
 private:
     bool enableVtkOutput_() const
     { return EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput); }
@@ -678,6 +719,8 @@ private:
     // Attributes required for the actual simulation
     Simulator& simulator_;
     mutable VtkMultiWriter *defaultVtkWriter_;
+
+    TimeStepController timeStepController_;
 };
 
 } // namespace Ewoms
@@ -168,6 +168,22 @@ NEW_PROP_TAG(ThreadsPerProcess);
 //! discretizations do not need this.)
 NEW_PROP_TAG(UseLinearizationLock);
 
+//! Avoid the linearization lock by partitioning the elements into chunks which are
+//! colored such that no two chunks of the same color write to the same degree of
+//! freedom. (this only has an effect if UseLinearizationLock is true and if more than a
+//! single thread is used.)
+NEW_PROP_TAG(EnableColoredLinearization);
+
+//! Update the cached intensive quantities of all degrees of freedom in a separate
+//! parallel pass before the elements are linearized. (this only has an effect if the
+//! intensive quantity cache is enabled and if UseLinearizationLock is false, i.e., if
+//! each degree of freedom is the primary degree of freedom of exactly one element.)
+NEW_PROP_TAG(EnableIntensiveQuantityPrecomputation);
+
+//! Allow threads which are done with their share of the grid's elements to take over
+//! elements which are assigned to other threads
+NEW_PROP_TAG(EnableWorkStealing);
+
 // high-level simulation control
 
 //! Manages the simulation time
@@ -193,13 +209,21 @@ NEW_PROP_TAG(EnableVtkOutput);
  * \brief Determines if the VTK output is written to disk asynchronously
  *
  * I.e. written to disk using a separate thread. This has only an effect if
- * EnableVtkOutput is true and if the simulation is run sequentially. The reasons for
- * this not being used for MPI-parallel simulations are that Dune's VTK output code does
- * not support multi-threaded multi-process VTK output and even if it would, the result
- * would be slower than when using synchronous output.
+ * EnableVtkOutput is true. For MPI-parallel simulations, each process writes its
+ * piece of the data set without communicating with the other processes.
  */
 NEW_PROP_TAG(EnableAsyncVtkOutput);
 
+/*!
+ * \brief The maximum number of VTK data sets which may wait for being written to disk
+ *        if the output is written asynchronously.
+ *
+ * If this number is reached, the simulation waits until the oldest data set has been
+ * written. This limits the amount of memory which is occupied by the output. 0 means
+ * that the number of data sets is not limited.
+ */
+NEW_PROP_TAG(VtkOutputMaxQueuedWrites);
+
 /*!
  * \brief Specify the format the VTK output is written to disk
  *
@@ -234,6 +258,37 @@ NEW_PROP_TAG(MinTimeStepSize);
  */
 NEW_PROP_TAG(MaxTimeStepDivisions);
 
+//! The class which decides about the size of time steps
+NEW_PROP_TAG(TimeStepController);
+
+/*!
+ * \brief The strategy used to select the size of the next time step.
+ *
+ * Valid values are "iterationcount" and "pid".
+ */
+NEW_PROP_TAG(TimeStepControl);
+
+/*!
+ * \brief The maximum change of the solution within a time step targeted by the PID
+ *        time step control.
+ */
+NEW_PROP_TAG(TimeStepControlTolerance);
+
+//! The maximum growth factor of the time step size for the PID time step control
+NEW_PROP_TAG(TimeStepControlMaxGrowth);
+
+/*!
+ * \brief The number of successful time steps for which a failed time step limits the
+ *        size of the following ones.
+ */
+NEW_PROP_TAG(TimeStepFailureMemory);
+
+/*!
+ * \brief Specify whether a failed time step should be retried starting from the last
+ *        iterate of the Newton method instead of the solution of the last time step.
+ */
+NEW_PROP_TAG(RestartFailedTimeStepFromLastIterate);
+
 /*!
  * \brief Specify whether all intensive quantities for the grid should be
  *        cached in the discretization.
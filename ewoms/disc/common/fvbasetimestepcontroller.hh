@@ -0,0 +1,297 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::FvBaseTimeStepController
+ */
+#ifndef EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+#define EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+
+#include "fvbaseproperties.hh"
+
+#include <ewoms/common/parametersystem.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+namespace Ewoms {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Decides about the size of time steps and about how failed time steps are
+ *        retried.
+ *
+ * Two strategies to select the size of the next time step are available:
+ *
+ * - "iterationcount": Use the number of Newton iterations of the last time step
+ *   (i.e., NewtonMethod::suggestTimeStepSize()). This is the default.
+ * - "pid": A PID controller which aims at a given maximum change of the solution
+ *   within a time step. The change is measured by the Newton method (see
+ *   NewtonMethod::solutionChange()); if the Newton method of the model does not
+ *   measure it, the iteration count based strategy is used as a fallback.
+ *
+ * Independently of this, the controller remembers the size of the time steps which
+ * failed during the current episode. If the TimeStepFailureMemory parameter is
+ * non-zero, these sizes are used to select smaller retry steps and to limit the size
+ * of the following time steps. Otherwise, a failed time step is simply retried with
+ * half its size. Finally, the controller records the wall clock time which was spent
+ * for failed attempts.
+ */
+template <class TypeTag>
+class FvBaseTimeStepController
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+
+    // coefficients of the PID controller. (see Söderlind and Wang: "Adaptive time
+    // stepping and computational stability", 2006)
+    static constexpr Scalar kP = 0.075;
+    static constexpr Scalar kI = 0.175;
+    static constexpr Scalar kD = 0.01;
+
+    enum class ControlType { IterationCount, Pid };
+
+    struct Failure
+    {
+        Scalar timeStepSize;
+        unsigned numSuccessfulSince;
+    };
+
+public:
+    FvBaseTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        const std::string& controlName = EWOMS_GET_PARAM(TypeTag, std::string, TimeStepControl);
+        if (controlName == "iterationcount")
+            controlType_ = ControlType::IterationCount;
+        else if (controlName == "pid")
+            controlType_ = ControlType::Pid;
+        else
+            throw std::runtime_error("Unknown time step control '"+controlName+"'. "
+                                     "Valid choices are 'iterationcount' and 'pid'");
+
+        tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance);
+        maxGrowth_ = EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth);
+        failureMemory_ = EWOMS_GET_PARAM(TypeTag, unsigned, TimeStepFailureMemory);
+        retryFromLastIterate_ = EWOMS_GET_PARAM(TypeTag, bool, RestartFailedTimeStepFromLastIterate);
+
+        episodeIdx_ = -1;
+        numFailedAttempts_ = 0;
+        wastedTime_ = 0.0;
+        resetErrorHistory_();
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, TimeStepControl,
+                             "The strategy used to select the size of the next time "
+                             "step. Valid values are 'iterationcount' and 'pid'");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The maximum change of the saturations and of the relative "
+                             "pressures within a time step targeted by the PID controller");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the time step size may grow "
+                             "from one time step to the next if the PID controller is used");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, TimeStepFailureMemory,
+                             "The number of successful time steps for which the size of a "
+                             "failed time step limits the size of the next ones and of their "
+                             "retries. 0 means that failed time steps do not limit the step size");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, RestartFailedTimeStepFromLastIterate,
+                             "Use the last iterate of a failed Newton method as the initial "
+                             "guess of the retry if the Newton method reduced the error");
+    }
+
+    /*!
+     * \brief Returns true if the controller uses the change of the solution within a
+     *        time step, i.e., if the Newton method needs to determine it.
+     */
+    bool needsSolutionChange() const
+    { return controlType_ == ControlType::Pid; }
+
+    /*!
+     * \brief Returns true if the last iterate of failed Newton methods should be used
+     *        as initial guess for the retry.
+     */
+    bool retryFromLastIterate() const
+    { return retryFromLastIterate_; }
+
+    /*!
+     * \brief Called if a time step size could not be solved.
+     *
+     * \param dt The size of the failed time step [s]
+     * \param wallTime The wall clock time which was spent on the failed attempt [s]
+     */
+    void attemptFailed(Scalar dt, Scalar wallTime)
+    {
+        checkEpisode_();
+
+        ++ numFailedAttempts_;
+        wastedTime_ += wallTime;
+
+        failures_.push_back(Failure{dt, /*numSuccessfulSince=*/0});
+        // we do not need to remember an arbitrary number of failures
+        while (failures_.size() > maxRememberedFailures_)
+            failures_.pop_front();
+
+        // the solution changes measured before the failure do not say much about the
+        // time step sizes which are possible now
+        resetErrorHistory_();
+    }
+
+    /*!
+     * \brief Called if a time step was solved successfully.
+     */
+    void attemptSucceeded()
+    {
+        checkEpisode_();
+
+        for (auto& failure : failures_)
+            ++ failure.numSuccessfulSince;
+    }
+
+    /*!
+     * \brief Returns the size of the time step which should be tried after a time
+     *        step of a given size failed.
+     */
+    Scalar retryTimeStepSize(Scalar failedDt) const
+    {
+        Scalar dt = failedDt/2;
+        if (failureMemory_ == 0)
+            return dt;
+
+        // if a time step which is smaller than the halved one has already failed
+        // during the current episode, there is no point in trying the halved one.
+        for (const auto& failure : failures_)
+            if (failure.timeStepSize <= dt)
+                dt = std::min(dt, failure.timeStepSize/2);
+
+        return dt;
+    }
+
+    /*!
+     * \brief Returns the size of the next time step after a successful one.
+     *
+     * \param dt The size of the time step which was just completed [s]
+     */
+    Scalar nextTimeStepSize(Scalar dt)
+    {
+        const auto& newtonMethod = simulator_.model().newtonMethod();
+
+        Scalar dtNext;
+        Scalar change = newtonMethod.solutionChange();
+        if (controlType_ == ControlType::Pid && change >= 0.0)
+            dtNext = pidTimeStepSize_(dt, change);
+        else
+            dtNext = newtonMethod.suggestTimeStepSize(dt);
+
+        // do not get close to the sizes which failed recently
+        for (const auto& failure : failures_)
+            if (failureMemory_ > 0 && failure.numSuccessfulSince <= failureMemory_)
+                dtNext = std::min(dtNext, failure.timeStepSize*0.9);
+
+        return dtNext;
+    }
+
+    /*!
+     * \brief Returns the number of failed attempts to solve a time step.
+     */
+    unsigned numFailedAttempts() const
+    { return numFailedAttempts_; }
+
+    /*!
+     * \brief Returns the wall clock time which was spent for failed attempts to solve
+     *        a time step [s].
+     */
+    Scalar wastedTime() const
+    { return wastedTime_; }
+
+private:
+    Scalar pidTimeStepSize_(Scalar dt, Scalar change)
+    {
+        // make sure that we do not divide by zero
+        Scalar error = std::max<Scalar>(change/tolerance_, 1e-10);
+
+        Scalar factor;
+        if (error > 1.0)
+            // the change was larger than the tolerance. for these time steps only
+            // the proportional control is used.
+            factor = 1.0/error;
+        else
+            factor =
+                std::pow(errors_[1]/error, kP)
+                * std::pow(1.0/error, kI)
+                * std::pow(errors_[1]*errors_[1]/(error*errors_[0]), kD);
+
+        errors_[0] = errors_[1];
+        errors_[1] = error;
+
+        return dt*std::min(factor, maxGrowth_);
+    }
+
+    void resetErrorHistory_()
+    {
+        errors_[0] = 1.0;
+        errors_[1] = 1.0;
+    }
+
+    // forget the failures if a new episode has begun: the conditions of an episode
+    // (e.g., well controls) may be completely different to the previous ones
+    void checkEpisode_()
+    {
+        if (simulator_.episodeIndex() == episodeIdx_)
+            return;
+
+        episodeIdx_ = simulator_.episodeIndex();
+        failures_.clear();
+        resetErrorHistory_();
+    }
+
+    static const size_t maxRememberedFailures_ = 10;
+
+    Simulator& simulator_;
+
+    ControlType controlType_;
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+    unsigned failureMemory_;
+    bool retryFromLastIterate_;
+
+    int episodeIdx_;
+    std::deque<Failure> failures_;
+    Scalar errors_[2];
+
+    unsigned numFailedAttempts_;
+    Scalar wastedTime_;
+};
+
+} // namespace Ewoms
+
+#endif
@@ -112,6 +112,9 @@ SET_BOOL_PROP(EcfvDiscretization, LinearizeNonLocalElements, true);
 //! conditions cannot occur since each matrix/vector entry is written exactly once
 SET_BOOL_PROP(EcfvDiscretization, UseLinearizationLock, false);
 
+//! the stencils are computed on the fly by default
+SET_BOOL_PROP(EcfvDiscretization, EnableStencilCache, false);
+
 } // namespace Properties
 } // namespace Ewoms
 
@@ -132,11 +135,67 @@ class EcfvDiscretization : public FvBaseDiscretization<TypeTag>
     typedef typename GET_PROP_TYPE(TypeTag, SolutionVector) SolutionVector;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
+    typedef typename Stencil::GeometryCache StencilGeometryCache;
 
 public:
     EcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        enableStencilCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStencilCache);
+        stencilCacheSeqNum_ = -1;
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the model.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStencilCache,
+                             "Compute the stencils of all elements once and share "
+                             "them between all element contexts");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        // the stencil cache must be available before the first element context is
+        // created
+        if (enableStencilCache_)
+            updateStencilCache_();
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateBegin()
+     */
+    void updateBegin()
+    {
+        // the grid may have been changed since the stencil cache was computed
+        if (enableStencilCache_
+            && stencilCacheSeqNum_ != this->simulator_.vanguard().gridSequenceNumber())
+            updateStencilCache_();
+
+        ParentType::updateBegin();
+    }
+
+    /*!
+     * \brief Prepare a stencil object before it is used for the first time.
+     *
+     * If the stencil cache is enabled, the stencil uses the precomputed geometric
+     * information of the elements instead of traversing the grid as long as the cache
+     * is up to date with the grid.
+     */
+    void initStencil(Stencil& stencil) const
+    {
+        if (enableStencilCache_)
+            stencil.setGeometryCache(&stencilCache_);
+    }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -190,7 +249,7 @@ public:
      */
     template <class Restarter>
     void serialize(Restarter& res)
-    { res.template serializeEntities</*codim=*/0>(asImp_(), this->gridView_); }
+    { this->template serializeSolution_</*dofCodim=*/0>(res); }
 
     /*!
      * \brief Deserializes the state of the model.
@@ -202,15 +261,28 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
-        res.template deserializeEntities</*codim=*/0>(asImp_(), this->gridView_);
+        this->template deserializeSolution_</*dofCodim=*/0>(res);
         this->solution(/*timeIdx=*/1) = this->solution(/*timeIdx=*/0);
     }
 
 private:
+    void updateStencilCache_()
+    {
+        const auto& vanguard = this->simulator_.vanguard();
+        stencilCache_.update(this->gridView_,
+                             this->elementMapper(),
+                             [&vanguard]() { return vanguard.gridSequenceNumber(); });
+        stencilCacheSeqNum_ = vanguard.gridSequenceNumber();
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    bool enableStencilCache_;
+    StencilGeometryCache stencilCache_;
+    int stencilCacheSeqNum_;
 };
 } // namespace Ewoms
 
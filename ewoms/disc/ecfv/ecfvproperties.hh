@@ -37,6 +37,10 @@ namespace Ewoms {
 namespace Properties {
 //! The type tag for models based on the ECFV-scheme
 NEW_TYPE_TAG(EcfvDiscretization, INHERITS_FROM(FvBaseDiscretization));
+
+//! Specify whether the stencils of all elements should be computed once and then be
+//! shared by all element contexts
+NEW_PROP_TAG(EnableStencilCache);
 }} // namespace Properties, Ewoms
 
 #endif
@@ -38,6 +38,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <functional>
 #include <vector>
 
 namespace Ewoms {
@@ -133,6 +134,12 @@ public:
         const LocalGeometry geometry() const
         { return element_.geometry(); }
 
+        /*!
+         * \brief The element which corresponds to the sub-control volume.
+         */
+        const Element& element() const
+        { return element_; }
+
     private:
         GlobalPosition centerPos_;
         Scalar volume_;
@@ -214,16 +221,183 @@ public:
     typedef EcfvSubControlVolumeFace<needFaceIntegrationPos, needFaceNormal> SubControlVolumeFace;
     typedef EcfvSubControlVolumeFace</*needFaceIntegrationPos=*/true, needFaceNormal> BoundaryFace;
 
+    /*!
+     * \brief Stores the stencils of all elements of a grid view.
+     *
+     * Since the geometry of the grid does not change unless the grid itself is
+     * changed, the stencils of all elements can be computed once and then be shared
+     * by all stencil objects. The data of the stencils is stored in flat arrays
+     * which are indexed by element index, so that updating a stencil object does not
+     * require to traverse the grid. If the grid is changed, the cache becomes stale
+     * and must be recomputed; stencils ignore a stale cache.
+     */
+    class GeometryCache
+    {
+    public:
+        GeometryCache()
+            : sequenceNumber_(-1)
+        {}
+
+        /*!
+         * \brief Compute the stencils of all elements of a grid view.
+         *
+         * \param gridView The grid view for which the stencils are computed
+         * \param elementMapper The mapper of the elements of the grid view
+         * \param gridSequenceNumber Returns the sequence number of the current grid. The
+         *                           cache is only used as long as it does not change.
+         */
+        void update(const GridView& gridView,
+                    const ElementMapper& elementMapper,
+                    std::function<int()> gridSequenceNumber)
+        {
+            gridSequenceNumber_ = gridSequenceNumber;
+            sequenceNumber_ = gridSequenceNumber_();
+
+            size_t numElements = static_cast<size_t>(gridView.size(/*codim=*/0));
+            subControlVolumes_.resize(numElements);
+            dofOffsets_.assign(numElements + 1, 0);
+            interiorFaceOffsets_.assign(numElements + 1, 0);
+            boundaryFaceOffsets_.assign(numElements + 1, 0);
+
+            // count the number of neighbors and boundary faces of each element
+            auto elemIt = gridView.template begin</*codim=*/0>();
+            const auto& elemEndIt = gridView.template end</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+                subControlVolumes_[elemIdx] = SubControlVolume(elem);
+
+                unsigned numInteriorFaces = 0;
+                unsigned numBoundaryFaces = 0;
+                auto isIt = gridView.ibegin(elem);
+                const auto& endIsIt = gridView.iend(elem);
+                for (; isIt != endIsIt; ++isIt) {
+                    if (isIt->neighbor())
+                        ++ numInteriorFaces;
+                    else
+                        ++ numBoundaryFaces;
+                }
+
+                dofOffsets_[elemIdx + 1] = numInteriorFaces + 1;
+                interiorFaceOffsets_[elemIdx + 1] = numInteriorFaces;
+                boundaryFaceOffsets_[elemIdx + 1] = numBoundaryFaces;
+            }
+
+            for (size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+                dofOffsets_[elemIdx + 1] += dofOffsets_[elemIdx];
+                interiorFaceOffsets_[elemIdx + 1] += interiorFaceOffsets_[elemIdx];
+                boundaryFaceOffsets_[elemIdx + 1] += boundaryFaceOffsets_[elemIdx];
+            }
+
+            dofIndices_.resize(dofOffsets_.back());
+            interiorFaces_.resize(interiorFaceOffsets_.back());
+            boundaryFaces_.resize(boundaryFaceOffsets_.back());
+
+            // fill the stencils in the same order as EcfvStencil::updateTopology()
+            elemIt = gridView.template begin</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+
+                unsigned dofPos = dofOffsets_[elemIdx];
+                unsigned interiorFacePos = interiorFaceOffsets_[elemIdx];
+                unsigned boundaryFacePos = boundaryFaceOffsets_[elemIdx];
+                dofIndices_[dofPos++] = elemIdx;
+
+                auto isIt = gridView.ibegin(elem);
+                const auto& endIsIt = gridView.iend(elem);
+                for (; isIt != endIsIt; ++isIt) {
+                    const auto& intersection = *isIt;
+                    if (intersection.neighbor()) {
+                        unsigned localNeighborIdx = dofPos - dofOffsets_[elemIdx];
+                        dofIndices_[dofPos++] =
+                            static_cast<unsigned>(elementMapper.index(intersection.outside()));
+                        interiorFaces_[interiorFacePos++] =
+                            SubControlVolumeFace(intersection, localNeighborIdx);
+                    }
+                    else
+                        boundaryFaces_[boundaryFacePos++] = BoundaryFace(intersection, - 10000);
+                }
+            }
+        }
+
+        /*!
+         * \brief Returns true iff the cache was computed for the current grid.
+         */
+        bool isUpToDate() const
+        { return gridSequenceNumber_ && sequenceNumber_ == gridSequenceNumber_(); }
+
+        const SubControlVolume& subControlVolume(unsigned elemIdx) const
+        { return subControlVolumes_[elemIdx]; }
+
+        unsigned numDof(unsigned elemIdx) const
+        { return dofOffsets_[elemIdx + 1] - dofOffsets_[elemIdx]; }
+
+        const unsigned* dofIndices(unsigned elemIdx) const
+        { return dofIndices_.data() + dofOffsets_[elemIdx]; }
+
+        unsigned numInteriorFaces(unsigned elemIdx) const
+        { return interiorFaceOffsets_[elemIdx + 1] - interiorFaceOffsets_[elemIdx]; }
+
+        const SubControlVolumeFace* interiorFaces(unsigned elemIdx) const
+        { return interiorFaces_.data() + interiorFaceOffsets_[elemIdx]; }
+
+        unsigned numBoundaryFaces(unsigned elemIdx) const
+        { return boundaryFaceOffsets_[elemIdx + 1] - boundaryFaceOffsets_[elemIdx]; }
+
+        const BoundaryFace* boundaryFaces(unsigned elemIdx) const
+        { return boundaryFaces_.data() + boundaryFaceOffsets_[elemIdx]; }
+
+    private:
+        // the sequence number of the grid for which the cache was computed and the
+        // function which returns the one of the current grid
+        int sequenceNumber_;
+        std::function<int()> gridSequenceNumber_;
+
+        // the "center" sub-control volume of each element
+        std::vector<SubControlVolume> subControlVolumes_;
+
+        // the global indices of the degrees of freedom of each stencil. the first one
+        // is always the element itself
+        std::vector<unsigned> dofOffsets_;
+        std::vector<unsigned> dofIndices_;
+
+        std::vector<unsigned> interiorFaceOffsets_;
+        std::vector<SubControlVolumeFace> interiorFaces_;
+
+        std::vector<unsigned> boundaryFaceOffsets_;
+        std::vector<BoundaryFace> boundaryFaces_;
+    };
+
     EcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , elementMapper_(mapper)
+        , geometryCache_(nullptr)
+        , useGeometryCache_(false)
     {
         // try to ensure that the mapper passed indeed maps elements
         assert(gridView.size(/*codim=*/0) == elementMapper_.size());
     }
 
+    /*!
+     * \brief Use precomputed stencils instead of traversing the grid.
+     *
+     * The cache is only used while it is up to date with the grid, i.e., the stencil
+     * computes its geometry on its own if the grid changed since the cache was
+     * computed. Passing a null pointer always makes the stencil compute its geometry
+     * on its own.
+     */
+    void setGeometryCache(const GeometryCache* cache)
+    { geometryCache_ = cache; }
+
     void updateTopology(const Element& element)
     {
+        useGeometryCache_ = geometryCache_ && geometryCache_->isUpToDate();
+        if (useGeometryCache_) {
+            useCachedStencil_(element, /*primaryOnly=*/false);
+            return;
+        }
+
         auto isIt = gridView_.ibegin(element);
         const auto& endIsIt = gridView_.iend(element);
 
@@ -254,6 +428,12 @@ public:
 
     void updatePrimaryTopology(const Element& element)
     {
+        useGeometryCache_ = geometryCache_ && geometryCache_->isUpToDate();
+        if (useGeometryCache_) {
+            useCachedStencil_(element, /*primaryOnly=*/true);
+            return;
+        }
+
         // add the "center" element of the stencil
         subControlVolumes_.clear();
         subControlVolumes_.emplace_back(/*SubControlVolume(*/element/*)*/);
@@ -289,7 +469,7 @@ public:
      *        current element interacts with.
      */
     size_t numDof() const
-    { return subControlVolumes_.size(); }
+    { return useGeometryCache_ ? cachedNumDof_ : subControlVolumes_.size(); }
 
     /*!
      * \brief Returns the number of degrees of freedom which are contained
@@ -311,6 +491,9 @@ public:
     {
         assert(0 <= dofIdx && dofIdx < numDof());
 
+        if (useGeometryCache_)
+            return cachedDofIndices_[dofIdx];
+
         return static_cast<unsigned>(elementMapper_.index(element(dofIdx)));
     }
 
@@ -318,7 +501,7 @@ public:
      * \brief Return partition type of a given degree of freedom
      */
     Dune::PartitionType partitionType(unsigned dofIdx) const
-    { return elements_[dofIdx]->partitionType(); }
+    { return element(dofIdx).partitionType(); }
 
     /*!
      * \brief Return the element given the index of a degree of
@@ -331,6 +514,9 @@ public:
     {
         assert(0 <= dofIdx && dofIdx < numDof());
 
+        if (useGeometryCache_)
+            return geometryCache_->subControlVolume(cachedDofIndices_[dofIdx]).element();
+
         return elements_[dofIdx];
     }
 
@@ -348,38 +534,75 @@ public:
      *        given degree of freedom.
      */
     const SubControlVolume& subControlVolume(unsigned dofIdx) const
-    { return subControlVolumes_[dofIdx]; }
+    {
+        if (useGeometryCache_)
+            return geometryCache_->subControlVolume(cachedDofIndices_[dofIdx]);
+
+        return subControlVolumes_[dofIdx];
+    }
 
     /*!
      * \brief Returns the number of interior faces of the stencil.
      */
     size_t numInteriorFaces() const
-    { return interiorFaces_.size(); }
+    { return useGeometryCache_ ? cachedNumInteriorFaces_ : interiorFaces_.size(); }
 
     /*!
      * \brief Returns the face object belonging to a given face index
      *        in the interior of the domain.
      */
     const SubControlVolumeFace& interiorFace(unsigned faceIdx) const
-    { return interiorFaces_[faceIdx]; }
+    { return useGeometryCache_ ? cachedInteriorFaces_[faceIdx] : interiorFaces_[faceIdx]; }
 
     /*!
      * \brief Returns the number of boundary faces of the stencil.
      */
     size_t numBoundaryFaces() const
-    { return boundaryFaces_.size(); }
+    { return useGeometryCache_ ? cachedNumBoundaryFaces_ : boundaryFaces_.size(); }
 
     /*!
      * \brief Returns the boundary face object belonging to a given
      *        boundary face index.
      */
     const BoundaryFace& boundaryFace(unsigned bfIdx) const
-    { return boundaryFaces_[bfIdx]; }
+    { return useGeometryCache_ ? cachedBoundaryFaces_[bfIdx] : boundaryFaces_[bfIdx]; }
 
 protected:
+    // point the stencil to the precomputed data of an element
+    void useCachedStencil_(const Element& element, bool primaryOnly)
+    {
+        unsigned elemIdx = static_cast<unsigned>(elementMapper_.index(element));
+
+        cachedDofIndices_ = geometryCache_->dofIndices(elemIdx);
+        cachedInteriorFaces_ = geometryCache_->interiorFaces(elemIdx);
+        cachedBoundaryFaces_ = geometryCache_->boundaryFaces(elemIdx);
+
+        if (primaryOnly) {
+            cachedNumDof_ = 1;
+            cachedNumInteriorFaces_ = 0;
+            cachedNumBoundaryFaces_ = 0;
+        }
+        else {
+            cachedNumDof_ = geometryCache_->numDof(elemIdx);
+            cachedNumInteriorFaces_ = geometryCache_->numInteriorFaces(elemIdx);
+            cachedNumBoundaryFaces_ = geometryCache_->numBoundaryFaces(elemIdx);
+        }
+    }
+
     const GridView&       gridView_;
     const ElementMapper&  elementMapper_;
 
+    // the geometry cache and whether it was used for the current element. the latter
+    // is not the case if the cache became stale because the grid was changed.
+    const GeometryCache* geometryCache_;
+    bool useGeometryCache_;
+    const unsigned* cachedDofIndices_;
+    const SubControlVolumeFace* cachedInteriorFaces_;
+    const BoundaryFace* cachedBoundaryFaces_;
+    size_t cachedNumDof_;
+    size_t cachedNumInteriorFaces_;
+    size_t cachedNumBoundaryFaces_;
+
     std::vector<Element> elements_;
     std::vector<SubControlVolume>      subControlVolumes_;
     std::vector<SubControlVolumeFace>  interiorFaces_;
@@ -165,7 +165,7 @@ public:
      */
     template <class Restarter>
     void serialize(Restarter& res)
-    { res.template serializeEntities</*codim=*/dim>(asImp_(), this->gridView_); }
+    { this->template serializeSolution_</*dofCodim=*/dim>(res); }
 
     /*!
      * \brief Deserializes the state of the model.
@@ -177,7 +177,7 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
-        res.template deserializeEntities</*codim=*/dim>(asImp_(), this->gridView_);
+        this->template deserializeSolution_</*dofCodim=*/dim>(res);
         this->solution(/*timeIdx=*/1) = this->solution(/*timeIdx=*/0);
     }
 
@@ -193,6 +193,8 @@ protected:
                     fractureMapper_.addFractureEdge(vertexIndices[0], vertexIndices[1]);
             }
         }
+
+        fractureMapper_.finalize();
     }
 
 private:
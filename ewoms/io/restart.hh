@@ -27,18 +27,89 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
+#include <ewoms/parallel/tasklets.hh>
+
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cassert>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace Ewoms {
 
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Restart files are binary files which consist of a header followed by a sequence of
+ * sections. Each section is identified by a cookie, and its payload is protected by a
+ * checksum. Sections can either be written using a text stream (which is convenient for
+ * small amounts of data) or as raw arrays of trivially copyable objects. The latter is
+ * much faster and more compact for the large arrays like the solution vector.
+ *
+ * For reading, the restart file is mapped into memory, i.e., raw arrays are directly
+ * copied from the mapped file. Text based restart files which were written by older
+ * versions can still be read, but they do not contain any raw arrays (see
+ * isLegacyFormat()). If a tasklet runner is specified, writing the restart file is
+ * done asynchronously: In this case, all data is collected in memory and the file is
+ * written by the tasklet runner once serializeEnd() is called.
  */
 class Restart
 {
+    static const std::uint32_t formatVersion_ = 1;
+
+    // all sections are aligned to this number of bytes, so that raw arrays can be
+    // accessed directly in the mapped file
+    static const size_t alignment_ = 8;
+
+    struct SectionHeader_
+    {
+        std::uint64_t cookieSize;
+        std::uint64_t payloadSize;
+        std::uint64_t checksum;
+    };
+
+    struct ArrayHeader_
+    {
+        std::uint64_t elementSize;
+        std::uint64_t numElements;
+    };
+
+    // writes the buffered contents of a restart file to disk
+    class WriteTasklet_ : public TaskletInterface
+    {
+    public:
+        WriteTasklet_(const std::string& fileName, std::shared_ptr<std::string> buffer)
+            : fileName_(fileName)
+            , buffer_(buffer)
+        {}
+
+        void run()
+        {
+            // the exception is stored by the tasklet runner and re-thrown by its
+            // barrier() method
+            std::ofstream os(fileName_.c_str(), std::ios::binary);
+            os.write(buffer_->data(), static_cast<std::streamsize>(buffer_->size()));
+            os.close();
+            if (!os.good())
+                throw std::runtime_error("Writing restart file '"+fileName_+"' failed");
+        }
+
+    private:
+        std::string fileName_;
+        std::shared_ptr<std::string> buffer_;
+    };
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -80,13 +151,47 @@ class Restart
         return oss.str();
     }
 
+    /*!
+     * \brief The identifier at the beginning of each restart file.
+     */
+    static const char* fileMagic_()
+    { return "eWomsRST"; }
+
+    /*!
+     * \brief The beginning of text based restart files which were written before the
+     *        binary format was introduced.
+     */
+    static const char* legacyFileMagic_()
+    { return "eWoms restart file: "; }
+
 public:
+    Restart()
+        : taskletRunner_(nullptr)
+        , mappedData_(nullptr)
+        , mappedSize_(0)
+        , readPos_(0)
+        , legacyFormat_(false)
+    {}
+
+    ~Restart()
+    { unmap_(); }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
     const std::string& fileName() const
     { return fileName_; }
 
+    /*!
+     * \brief Specify a tasklet runner which writes the restart file asynchronously.
+     *
+     * The tasklet runner must be alive until the file has been written, i.e., until
+     * its barrier() method has been called or it has been destroyed. Pass a null
+     * pointer for writing restart files synchronously.
+     */
+    void setTaskletRunner(TaskletRunner* taskletRunner)
+    { taskletRunner_ = taskletRunner; }
+
     /*!
      * \brief Write the current state of the model to disk.
      */
@@ -98,9 +203,21 @@ public:
                                      simulator.problem().name(),
                                      simulator.time());
 
-        // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
-        outStream_.precision(20);
+        // open output file or the buffer for asynchronous writing
+        if (taskletRunner_)
+            outBuffer_ = std::make_shared<std::string>();
+        else {
+            outStream_.open(fileName_.c_str(), std::ios::binary);
+            if (!outStream_.good())
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened for writing");
+        }
+
+        // write the file header and the magic cookie
+        std::uint32_t fileHeader[4];
+        std::memcpy(fileHeader, fileMagic_(), 2*sizeof(std::uint32_t));
+        fileHeader[2] = formatVersion_;
+        fileHeader[3] = 0;
+        write_(fileHeader, sizeof(fileHeader));
 
         serializeSectionBegin(magicCookie);
         serializeSectionEnd();
@@ -110,19 +227,28 @@ public:
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    { return sectionOutStream_; }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        sectionCookie_ = cookie;
+        sectionOutStream_.str("");
+        sectionOutStream_.clear();
+        sectionOutStream_.precision(20);
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        const std::string& payload = sectionOutStream_.str();
+        writeSection_(sectionCookie_, /*prefix=*/nullptr, /*prefixSize=*/0, payload.data(), payload.size());
+        sectionOutStream_.str("");
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
@@ -143,18 +269,48 @@ public:
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
         for (; it != endIt; ++it) {
-            serializer.serializeEntity(outStream_, *it);
-            outStream_ << "\n";
+            serializer.serializeEntity(sectionOutStream_, *it);
+            sectionOutStream_ << "\n";
         }
 
         serializeSectionEnd();
     }
 
+    /*!
+     * \brief Serialize a contiguous array of trivially copyable objects as a section of
+     *        its own.
+     *
+     * The objects are written bitwise, i.e., the restart file can only be read on
+     * machines which use the same representation of the objects.
+     */
+    template <class T>
+    void serializeArray(const std::string& cookie, const T* data, size_t numElements)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only arrays of trivially copyable objects can be serialized bitwise");
+
+        ArrayHeader_ arrayHeader;
+        arrayHeader.elementSize = sizeof(T);
+        arrayHeader.numElements = numElements;
+        writeSection_("Array: "+cookie,
+                      reinterpret_cast<const char*>(&arrayHeader), sizeof(arrayHeader),
+                      reinterpret_cast<const char*>(data), numElements*sizeof(T));
+    }
+
     /*!
      * \brief Finish the restart file.
+     *
+     * If a tasklet runner has been specified, the file is written to disk by it.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (outBuffer_) {
+            taskletRunner_->dispatch(std::make_shared<WriteTasklet_>(fileName_, outBuffer_));
+            outBuffer_.reset();
+        }
+        else
+            outStream_.close();
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -165,19 +321,52 @@ public:
     {
         fileName_ = restartFileName_(simulator.gridView(), simulator.problem().name(), t);
 
-        // open input file and read magic cookie
-        inStream_.open(fileName_.c_str());
-        if (!inStream_.good()) {
+        // map the input file into memory
+        int fd = ::open(fileName_.c_str(), O_RDONLY);
+        if (fd < 0)
             throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not determine the size of restart file '"+fileName_+"'");
         }
 
         // make sure that we don't open an empty file
-        inStream_.seekg(0, std::ios::end);
-        auto pos = inStream_.tellg();
-        if (pos == 0) {
+        mappedSize_ = static_cast<size_t>(fileStat.st_size);
+        if (mappedSize_ == 0) {
+            ::close(fd);
             throw std::runtime_error("Restart file '"+fileName_+"' is empty");
         }
-        inStream_.seekg(0, std::ios::beg);
+
+        void* addr = ::mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, /*offset=*/0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            mappedSize_ = 0;
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be mapped into memory");
+        }
+        mappedData_ = static_cast<const char*>(addr);
+        readPos_ = 0;
+
+        // check the file header and the magic cookie
+        size_t legacyMagicSize = std::strlen(legacyFileMagic_());
+        legacyFormat_ =
+            mappedSize_ >= legacyMagicSize
+            && std::memcmp(mappedData_, legacyFileMagic_(), legacyMagicSize) == 0;
+        if (legacyFormat_) {
+            // text based restart files are read line by line from a single stream
+            sectionInStream_.str(std::string(mappedData_, mappedSize_));
+            sectionInStream_.clear();
+            unmap_();
+        }
+        else {
+            std::uint32_t fileHeader[4];
+            read_(fileHeader, sizeof(fileHeader));
+            if (std::memcmp(fileHeader, fileMagic_(), 2*sizeof(std::uint32_t)) != 0)
+                throw std::runtime_error("File '"+fileName_+"' is not an eWoms restart file");
+            if (fileHeader[2] != formatVersion_)
+                throw std::runtime_error("Restart file '"+fileName_+"' uses an unsupported format version");
+        }
 
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
 
@@ -185,24 +374,43 @@ public:
         deserializeSectionEnd();
     }
 
+    /*!
+     * \brief Returns true if the restart file which is read uses the text based format
+     *        of older versions.
+     *
+     * Such files do not contain any sections written by serializeArray().
+     */
+    bool isLegacyFormat() const
+    { return legacyFormat_; }
+
     /*!
      * \brief The input stream to read the data which ought to be
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    { return sectionInStream_; }
 
     /*!
      * \brief Start reading a new section of the restart file.
      */
     void deserializeSectionBegin(const std::string& cookie)
     {
-        if (!inStream_.good())
-            throw std::runtime_error("Encountered unexpected EOF in restart file.");
-        std::string buf;
-        std::getline(inStream_, buf);
-        if (buf != cookie)
-            throw std::runtime_error("Could not start section '"+cookie+"'");
+        if (legacyFormat_) {
+            if (!sectionInStream_.good())
+                throw std::runtime_error("Encountered unexpected EOF in restart file.");
+            std::string buf;
+            std::getline(sectionInStream_, buf);
+            if (buf != cookie)
+                throw std::runtime_error("Could not start section '"+cookie+"'");
+            return;
+        }
+
+        const char* payload;
+        size_t payloadSize;
+        readSection_(cookie, payload, payloadSize);
+
+        sectionInStream_.str(std::string(payload, payloadSize));
+        sectionInStream_.clear();
     }
 
     /*!
@@ -211,12 +419,25 @@ public:
     void deserializeSectionEnd()
     {
         std::string dummy;
-        std::getline(inStream_, dummy);
-        for (unsigned i = 0; i < dummy.length(); ++i) {
-            if (!std::isspace(dummy[i])) {
-                throw std::logic_error("Encountered unread values while deserializing");
+        if (legacyFormat_) {
+            // in text based restart files, sections are terminated by a single line
+            std::getline(sectionInStream_, dummy);
+            for (unsigned i = 0; i < dummy.length(); ++i) {
+                if (!std::isspace(dummy[i])) {
+                    throw std::logic_error("Encountered unread values while deserializing");
+                }
             }
+            return;
         }
+
+        while (std::getline(sectionInStream_, dummy)) {
+            for (unsigned i = 0; i < dummy.length(); ++i) {
+                if (!std::isspace(dummy[i])) {
+                    throw std::logic_error("Encountered unread values while deserializing");
+                }
+            }
+        }
+        sectionInStream_.str("");
     }
 
     /*!
@@ -239,11 +460,11 @@ public:
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
         for (; it != endIt; ++it) {
-            if (!inStream_.good()) {
+            if (!sectionInStream_.good()) {
                 throw std::runtime_error("Restart file is corrupted");
             }
 
-            std::getline(inStream_, curLine);
+            std::getline(sectionInStream_, curLine);
             std::istringstream curLineStream(curLine);
             deserializer.deserializeEntity(curLineStream, *it);
         }
@@ -251,16 +472,173 @@ public:
         deserializeSectionEnd();
     }
 
+    /*!
+     * \brief Deserialize a contiguous array of trivially copyable objects which was
+     *        written by serializeArray().
+     *
+     * The data is directly copied from the memory mapped restart file.
+     */
+    template <class T>
+    void deserializeArray(const std::string& cookie, T* data, size_t numElements)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only arrays of trivially copyable objects can be deserialized bitwise");
+
+        if (legacyFormat_)
+            throw std::logic_error("Text based restart file '"+fileName_+"' does not contain "
+                                   "array '"+cookie+"'");
+
+        const char* payload;
+        size_t payloadSize;
+        readSection_("Array: "+cookie, payload, payloadSize);
+
+        ArrayHeader_ arrayHeader;
+        if (payloadSize < sizeof(arrayHeader))
+            throw std::runtime_error("Restart file is corrupted");
+        std::memcpy(&arrayHeader, payload, sizeof(arrayHeader));
+
+        if (arrayHeader.elementSize != sizeof(T)
+            || arrayHeader.numElements != numElements
+            || payloadSize != sizeof(arrayHeader) + numElements*sizeof(T))
+            throw std::runtime_error("Array '"+cookie+"' of the restart file exhibits an unexpected size");
+
+        if (numElements > 0)
+            std::memcpy(data, payload + sizeof(arrayHeader), numElements*sizeof(T));
+    }
+
     /*!
      * \brief Stop reading the restart file.
      */
     void deserializeEnd()
-    { inStream_.close(); }
+    {
+        unmap_();
+        sectionInStream_.str("");
+        legacyFormat_ = false;
+    }
 
 private:
+    // a simple checksum which processes eight bytes at once. if the data is split into
+    // several pieces, all but the last must exhibit a size divisible by eight.
+    static std::uint64_t checksum_(const char* data,
+                                   size_t size,
+                                   std::uint64_t hash = 14695981039346656037ULL)
+    {
+        static const std::uint64_t prime = 1099511628211ULL;
+
+        size_t numWords = size/sizeof(std::uint64_t);
+        for (size_t i = 0; i < numWords; ++i) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i*sizeof(word), sizeof(word));
+            hash = (hash ^ word)*prime;
+        }
+
+        for (size_t i = numWords*sizeof(std::uint64_t); i < size; ++i)
+            hash = (hash ^ static_cast<unsigned char>(data[i]))*prime;
+
+        return hash;
+    }
+
+    static size_t alignedSize_(size_t size)
+    { return ((size + alignment_ - 1)/alignment_)*alignment_; }
+
+    void write_(const void* data, size_t size)
+    {
+        if (outBuffer_)
+            outBuffer_->append(static_cast<const char*>(data), size);
+        else
+            outStream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+    void writePadding_(size_t size)
+    {
+        static const char zeros[alignment_] = { 0 };
+        write_(zeros, alignedSize_(size) - size);
+    }
+
+    // the payload of a section is the concatenation of the prefix and the data
+    void writeSection_(const std::string& cookie,
+                       const char* prefix,
+                       size_t prefixSize,
+                       const char* data,
+                       size_t dataSize)
+    {
+        assert(prefixSize % sizeof(std::uint64_t) == 0);
+
+        SectionHeader_ sectionHeader;
+        sectionHeader.cookieSize = cookie.size();
+        sectionHeader.payloadSize = prefixSize + dataSize;
+        sectionHeader.checksum = checksum_(data, dataSize, checksum_(prefix, prefixSize));
+
+        write_(&sectionHeader, sizeof(sectionHeader));
+        write_(cookie.data(), cookie.size());
+        writePadding_(cookie.size());
+        if (prefixSize > 0)
+            write_(prefix, prefixSize);
+        if (dataSize > 0)
+            write_(data, dataSize);
+        writePadding_(prefixSize + dataSize);
+
+        if (!outBuffer_ && !outStream_.good())
+            throw std::runtime_error("Could not write section '"+cookie+"' of restart file '"+fileName_+"'");
+    }
+
+    void read_(void* data, size_t size)
+    {
+        if (readPos_ + size > mappedSize_)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+        std::memcpy(data, mappedData_ + readPos_, size);
+        readPos_ += size;
+    }
+
+    // return a pointer to the payload of the next section and check its integrity
+    void readSection_(const std::string& cookie, const char*& payload, size_t& payloadSize)
+    {
+        SectionHeader_ sectionHeader;
+        read_(&sectionHeader, sizeof(sectionHeader));
+
+        size_t cookieSize = static_cast<size_t>(sectionHeader.cookieSize);
+        payloadSize = static_cast<size_t>(sectionHeader.payloadSize);
+        if (readPos_ + alignedSize_(cookieSize) + alignedSize_(payloadSize) > mappedSize_)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+        if (cookie != std::string(mappedData_ + readPos_, cookieSize))
+            throw std::runtime_error("Could not start section '"+cookie+"'");
+        readPos_ += alignedSize_(cookieSize);
+
+        payload = mappedData_ + readPos_;
+        readPos_ += alignedSize_(payloadSize);
+
+        if (checksum_(payload, payloadSize) != sectionHeader.checksum)
+            throw std::runtime_error("Checksum mismatch in section '"+cookie+"' of restart file '"
+                                     +fileName_+"'");
+    }
+
+    void unmap_()
+    {
+        if (mappedData_)
+            ::munmap(const_cast<char*>(mappedData_), mappedSize_);
+
+        mappedData_ = nullptr;
+        mappedSize_ = 0;
+        readPos_ = 0;
+    }
+
     std::string fileName_;
-    std::ifstream inStream_;
+
+    // writing
+    TaskletRunner* taskletRunner_;
+    std::shared_ptr<std::string> outBuffer_;
     std::ofstream outStream_;
+    std::string sectionCookie_;
+    std::ostringstream sectionOutStream_;
+
+    // reading
+    const char* mappedData_;
+    size_t mappedSize_;
+    size_t readPos_;
+    bool legacyFormat_;
+    std::istringstream sectionInStream_;
 };
 } // namespace Ewoms
 
@@ -46,6 +46,8 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
+#include <iostream>
 #include <list>
 #include <string>
 #include <limits>
@@ -63,31 +65,6 @@ namespace Ewoms {
 template <class GridView, int vtkFormat>
 class VtkMultiWriter : public BaseOutputWriter
 {
-    class WriteDataTasklet : public TaskletInterface
-    {
-    public:
-        WriteDataTasklet(VtkMultiWriter& multiWriter)
-            : multiWriter_(multiWriter)
-        { }
-
-        void run() final
-        {
-            std::string fileName;
-            // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
-            fileName = multiWriter_.curWriter_->write(/*name=*/multiWriter_.curOutFileName_.c_str(),
-                                                      static_cast<Dune::VTK::OutputType>(vtkFormat));
-
-            // determine name to write into the multi-file for the
-            // current time step
-            multiWriter_.multiFile_.precision(16);
-            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << multiWriter_.curTime_ << "\" file=\""
-                                    << fileName << "\"/>\n";
-        }
-
-    private:
-        VtkMultiWriter& multiWriter_;
-    };
-
     enum { dim = GridView::dimension };
 
 #if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
@@ -113,10 +90,115 @@ public:
     typedef typename VtkWriter::VTKFunctionPtr FunctionPtr;
 #endif
 
+private:
+    // when writing a parallel data set, DUNE's VTK writer synchronizes all processes.
+    // since this must not happen on the thread which writes the data asynchronously,
+    // this writer writes the piece of the current process without any communication.
+    // the .pvtu file which refers to the pieces of all processes is written by the
+    // first process.
+    class PieceVtkWriter : public VtkWriter
+    {
+    public:
+        PieceVtkWriter(const GridView& gridView)
+            : VtkWriter(gridView, Dune::VTK::conforming)
+        {}
+
+        std::string writePiece(const std::string& name,
+                               Dune::VTK::OutputType type,
+                               int commRank,
+                               int commSize)
+        {
+            if (commSize == 1)
+                return VtkWriter::write(name, type, /*commRank=*/0, /*commSize=*/1);
+
+            // the writer appends the file extension itself
+            std::string pieceName = this->getParallelPieceName(name, /*path=*/"", commRank, commSize);
+            pieceName = pieceName.substr(0, pieceName.rfind('.'));
+            VtkWriter::write(pieceName, type, /*commRank=*/0, /*commSize=*/1);
+
+            // the meta data file does not contain any data, so it does not matter
+            // whether the pieces of the other processes have already been written
+            std::string headerName = this->getParallelHeaderName(name, /*path=*/"", commSize);
+            if (commRank == 0) {
+                std::ofstream headerFile(headerName.c_str());
+                this->writeParallelHeader(headerFile, name, /*piecePath=*/"", commSize);
+            }
+
+            return headerName;
+        }
+    };
+
+    class WriteDataTasklet : public TaskletInterface
+    {
+    public:
+        // the tasklet takes over the ownership of the VTK writer and of the managed
+        // buffers of the data set, so that the multi-writer can already start with
+        // the next one while the tasklet is not yet finished
+        WriteDataTasklet(VtkMultiWriter& multiWriter)
+            : multiWriter_(multiWriter)
+            , writer_(multiWriter.curWriter_)
+            , outFileName_(multiWriter.curOutFileName_)
+            , time_(multiWriter.curTime_)
+        {
+            multiWriter.curWriter_ = nullptr;
+            scalarBuffers_.swap(multiWriter.managedScalarBuffers_);
+            vectorBuffers_.swap(multiWriter.managedVectorBuffers_);
+            tensorBuffers_.swap(multiWriter.managedTensorBuffers_);
+        }
+
+        ~WriteDataTasklet()
+        {
+            delete writer_;
+            VtkMultiWriter::deleteBuffers_(scalarBuffers_);
+            VtkMultiWriter::deleteBuffers_(vectorBuffers_);
+            VtkMultiWriter::deleteBuffers_(tensorBuffers_);
+        }
+
+        void run() final
+        {
+            std::string fileName;
+            // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
+            fileName = writer_->writePiece(/*name=*/outFileName_,
+                                           static_cast<Dune::VTK::OutputType>(vtkFormat),
+                                           multiWriter_.commRank_,
+                                           multiWriter_.commSize_);
+
+            // determine name to write into the multi-file for the
+            // current time step
+            multiWriter_.multiFile_.precision(16);
+            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << time_ << "\" file=\""
+                                    << fileName << "\"/>\n";
+
+            // temporarily write the closing XML mumbo-jumbo to the mashup
+            // file so that the data set can be loaded even if the
+            // simulation is aborted (or not yet finished)
+            multiWriter_.finishMultiFile_();
+        }
+
+    private:
+        VtkMultiWriter& multiWriter_;
+        PieceVtkWriter* writer_;
+        std::string outFileName_;
+        double time_;
+        std::list<ScalarBuffer*> scalarBuffers_;
+        std::list<VectorBuffer*> vectorBuffers_;
+        std::list<TensorBuffer*> tensorBuffers_;
+    };
+
+public:
+    /*!
+     * \brief Create a multi-file VTK writer.
+     *
+     * If asyncWriting is true, the data is written by a separate thread. In this case,
+     * at most maxQueuedWrites data sets (0 means unlimited) may wait for being written
+     * while the simulation continues. This also works for parallel simulations because
+     * the files are written without any communication between the processes.
+     */
     VtkMultiWriter(bool asyncWriting,
                    const GridView& gridView,
                    const std::string& simName = "",
-                   std::string multiFileName = "")
+                   std::string multiFileName = "",
+                   unsigned maxQueuedWrites = 2)
         : gridView_(gridView)
 #if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
@@ -127,7 +209,7 @@ public:
 #endif
         , curWriter_(nullptr)
         , curWriterNum_(0)
-        , taskletRunner_(/*numThreads=*/asyncWriting?1:0)
+        , taskletRunner_(/*numThreads=*/asyncWriting?1:0, maxQueuedWrites)
     {
         simName_ = (simName.empty()) ? "sim" : simName;
         multiFileName_ = multiFileName;
@@ -142,7 +224,12 @@ public:
 
     ~VtkMultiWriter()
     {
-        taskletRunner_.barrier();
+        try {
+            waitForAllProcesses_();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Writing VTK output failed: " << e.what() << "\n";
+        }
         releaseBuffers_();
         finishMultiFile_();
 
@@ -165,6 +252,9 @@ public:
      */
     void gridChanged()
     {
+        // the pending data sets still use the mappers
+        taskletRunner_.barrier();
+
         elementMapper_.update();
         vertexMapper_.update();
     }
@@ -178,15 +268,14 @@ public:
             startMultiFile_(multiFileName_);
         }
 
-        // make sure that all previous output has been written and no other thread
-        // accesses the memory used as the target for the extracted quantities
-        taskletRunner_.barrier();
+        // the data of previous time steps which still need to be written is owned by
+        // the respective tasklets, so we do not need to wait for them here
         releaseBuffers_();
 
         curTime_ = t;
         curOutFileName_ = fileName_();
 
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        curWriter_ = new PieceVtkWriter(gridView_);
         ++curWriterNum_;
     }
 
@@ -243,7 +332,7 @@ public:
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     vertexMapper_,
-                                    buf,
+                                    ownedBuffer_(buf, managedScalarBuffers_),
                                     /*codim=*/dim));
         curWriter_->addVertexData(fnPtr);
     }
@@ -271,7 +360,7 @@ public:
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     elementMapper_,
-                                    buf,
+                                    ownedBuffer_(buf, managedScalarBuffers_),
                                     /*codim=*/0));
         curWriter_->addCellData(fnPtr);
     }
@@ -300,7 +389,7 @@ public:
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     vertexMapper_,
-                                    buf,
+                                    ownedBuffer_(buf, managedVectorBuffers_),
                                     /*codim=*/dim));
         curWriter_->addVertexData(fnPtr);
     }
@@ -310,16 +399,17 @@ public:
      */
     void attachTensorVertexData(TensorBuffer& buf, std::string name)
     {
+        const TensorBuffer& ownedBuf = ownedBuffer_(buf, managedTensorBuffers_);
         typedef Ewoms::VtkTensorFunction<GridView, VertexMapper> VtkFn;
 
-        for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
+        for (unsigned colIdx = 0; colIdx < ownedBuf[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         vertexMapper_,
-                                        buf,
+                                        ownedBuf,
                                         /*codim=*/dim,
                                         colIdx));
             curWriter_->addVertexData(fnPtr);
@@ -349,7 +439,7 @@ public:
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     elementMapper_,
-                                    buf,
+                                    ownedBuffer_(buf, managedVectorBuffers_),
                                     /*codim=*/0));
         curWriter_->addCellData(fnPtr);
     }
@@ -359,16 +449,17 @@ public:
      */
     void attachTensorElementData(TensorBuffer& buf, std::string name)
     {
+        const TensorBuffer& ownedBuf = ownedBuffer_(buf, managedTensorBuffers_);
         typedef Ewoms::VtkTensorFunction<GridView, ElementMapper> VtkFn;
 
-        for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
+        for (unsigned colIdx = 0; colIdx < ownedBuf[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         elementMapper_,
-                                        buf,
+                                        ownedBuf,
                                         /*codim=*/0,
                                         colIdx));
             curWriter_->addCellData(fnPtr);
@@ -385,24 +476,31 @@ public:
     void endWrite(bool onlyDiscard = false)
     {
         if (!onlyDiscard) {
+            // this blocks if too many data sets are waiting for being written
             auto tasklet = std::make_shared<WriteDataTasklet>(*this);
             taskletRunner_.dispatch(tasklet);
         }
-        else
+        else {
             --curWriterNum_;
-
-        // temporarily write the closing XML mumbo-jumbo to the mashup
-        // file so that the data set can be loaded even if the
-        // simulation is aborted (or not yet finished)
-        finishMultiFile_();
+            releaseBuffers_();
+        }
     }
 
+    /*!
+     * \brief Returns the statistics about the data sets written so far.
+     */
+    TaskletStatistics writeStatistics() const
+    { return taskletRunner_.statistics(); }
+
     /*!
      * \brief Write the multi-writer's state to a restart file.
      */
     template <class Restarter>
     void serialize(Restarter& res)
     {
+        // the meta file must be complete
+        waitForAllProcesses_();
+
         res.serializeSectionBegin("VTKMultiWriter");
         res.serializeStream() << curWriterNum_ << "\n";
 
@@ -437,6 +535,8 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
+        taskletRunner_.barrier();
+
         res.deserializeSectionBegin("VTKMultiWriter");
         res.deserializeStream() >> curWriterNum_;
 
@@ -483,6 +583,15 @@ private:
     std::string fileSuffix_()
     { return (GridView::dimension == 1) ? "vtp" : "vtu"; }
 
+    // wait until the data sets of all processes have been written completely
+    void waitForAllProcesses_()
+    {
+        taskletRunner_.barrier();
+
+        if (commSize_ > 1)
+            gridView_.comm().barrier();
+    }
+
     void startMultiFile_(const std::string& multiFileName)
     {
         // only the first process writes to the multi-file
@@ -523,20 +632,39 @@ private:
         // nothing to do: this is done by VtkVectorFunction
     }
 
+    // if the output is written asynchronously, the caller may modify a buffer which is
+    // not managed by the multi-writer before the data is written. in this case, the
+    // multi-writer uses a managed copy of the buffer.
+    template <class Buffer>
+    const Buffer& ownedBuffer_(const Buffer& buf, std::list<Buffer*>& managedBuffers)
+    {
+        if (taskletRunner_.numWorkerThreads() == 0
+            || std::find(managedBuffers.begin(), managedBuffers.end(), &buf) != managedBuffers.end())
+            return buf;
+
+        Buffer* bufCopy = new Buffer(buf);
+        managedBuffers.push_back(bufCopy);
+        return *bufCopy;
+    }
+
+    template <class Buffer>
+    static void deleteBuffers_(std::list<Buffer*>& buffers)
+    {
+        while (buffers.begin() != buffers.end()) {
+            delete buffers.front();
+            buffers.pop_front();
+        }
+    }
+
     // release the memory occupied by all buffer objects managed by the multi-writer
     void releaseBuffers_()
     {
         // discard managed objects and the current VTK writer
         delete curWriter_;
         curWriter_ = nullptr;
-        while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
-            delete managedScalarBuffers_.front();
-            managedScalarBuffers_.pop_front();
-        }
-        while (managedVectorBuffers_.begin() != managedVectorBuffers_.end()) {
-            delete managedVectorBuffers_.front();
-            managedVectorBuffers_.pop_front();
-        }
+        deleteBuffers_(managedScalarBuffers_);
+        deleteBuffers_(managedVectorBuffers_);
+        deleteBuffers_(managedTensorBuffers_);
     }
 
     const GridView gridView_;
@@ -550,13 +678,14 @@ private:
     int commSize_; // number of processes in the communicator
     int commRank_; // rank of the current process in the communicator
 
-    VtkWriter *curWriter_;
+    PieceVtkWriter *curWriter_;
     double curTime_;
     std::string curOutFileName_;
     int curWriterNum_;
 
     std::list<ScalarBuffer *> managedScalarBuffers_;
     std::list<VectorBuffer *> managedVectorBuffers_;
+    std::list<TensorBuffer *> managedTensorBuffers_;
 
     TaskletRunner taskletRunner_;
 };
@@ -40,31 +40,92 @@
 
 namespace Ewoms {
 namespace Linear {
+/*!
+ * \brief The temporary vectors used by the stabilized BiCG linear solver.
+ *
+ * Linear solvers are usually applied once per Newton iteration. Keeping the workspace
+ * alive between solves avoids allocating the vectors each time.
+ */
+template <class Vector>
+class BiCGStabWorkspace
+{
+public:
+    BiCGStabWorkspace()
+        : isValid_(false)
+    {}
+
+    /*!
+     * \brief Make sure that all vectors are compatible with a given one.
+     *
+     * The vectors are only reallocated if the workspace has been cleared or if the
+     * size of the template vector has changed.
+     */
+    void prepare(const Vector& templateVector)
+    {
+        if (isValid_ && r.size() == templateVector.size())
+            return;
+
+        r = templateVector;
+        v = templateVector;
+        p = templateVector;
+        y = templateVector;
+        z = templateVector;
+        isValid_ = true;
+    }
+
+    /*!
+     * \brief Mark the workspace as invalid.
+     *
+     * This must be called if the layout of the vectors changes, e.g. because the
+     * overlap of the linear system has been recreated.
+     */
+    void clear()
+    { isValid_ = false; }
+
+    Vector r;
+    Vector v;
+    Vector p;
+    Vector y;
+    Vector z;
+
+private:
+    bool isValid_;
+};
+
 /*!
  * \brief Implements a preconditioned stabilized BiCG linear solver.
  *
  * This solves a linear system of equations Ax = b, where the matrix A is sparse and may
  * be unsymmetric.
  *
+ * Besides the usual dot() method, the scalar product is required to provide the
+ * iAmMasterOf() and sum() methods of the OverlappingScalarProduct. These are used to
+ * compute several dot products in a single pass over the vectors and to reduce them
+ * over all processes using a single collective operation.
+ *
  * See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method, (article
  * date: December 19, 2016)
  */
-template <class LinearOperator, class Vector, class Preconditioner>
+template <class LinearOperator, class Vector, class Preconditioner, class ScalarProduct>
 class BiCGStabSolver
 {
     typedef Ewoms::Linear::ConvergenceCriterion<Vector> ConvergenceCriterion;
+    typedef Ewoms::Linear::BiCGStabWorkspace<Vector> Workspace;
     typedef typename LinearOperator::field_type Scalar;
 
+    enum { blockSize = Vector::block_type::dimension };
+
 public:
     BiCGStabSolver(Preconditioner& preconditioner,
                    ConvergenceCriterion& convergenceCriterion,
-                   Dune::ScalarProduct<Vector>& scalarProduct)
+                   ScalarProduct& scalarProduct)
         : preconditioner_(preconditioner)
         , convergenceCriterion_(convergenceCriterion)
         , scalarProduct_(scalarProduct)
     {
         A_ = nullptr;
         b_ = nullptr;
+        workspace_ = nullptr;
 
         maxIterations_ = 1000;
     }
@@ -114,6 +175,15 @@ public:
     void setRhs(const Vector* b)
     { b_ = b; }
 
+    /*!
+     * \brief Set the object which provides the temporary vectors of the solver.
+     *
+     * The workspace is not owned by the solver. If no workspace is specified, the
+     * solver allocates its own one.
+     */
+    void setWorkspace(Workspace* workspace)
+    { workspace_ = workspace; }
+
     /*!
      * \brief Run the stabilized BiCG solver and store the result into the "x" vector.
      */
@@ -130,6 +200,13 @@ public:
         Ewoms::TimerGuard reportTimerGuard(report_.timer());
         report_.timer().start();
 
+        if (!workspace_) {
+            ownWorkspace_.reset(new Workspace);
+            workspace_ = ownWorkspace_.get();
+        }
+        Workspace& ws = *workspace_;
+        ws.prepare(*b_);
+
         // preconditioned stabilized biconjugate gradient method
         //
         // See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method,
@@ -141,7 +218,8 @@ public:
         // prepare the preconditioner. to allow some optimizations, we assume that the
         // preconditioner does not change the initial solution x if the initial solution
         // is a zero vector.
-        Vector r = *b_;
+        Vector& r = ws.r;
+        r = *b_;
         preconditioner_.pre(x, r);
 
 #ifndef NDEBUG
@@ -179,23 +257,28 @@ public:
         Scalar omega = 1.0;
 
         // v_0 = p_0 = 0;
-        Vector v(r);
+        Vector& v = ws.v;
+        Vector& p = ws.p;
         v = 0.0;
-        Vector p(v);
+        p = 0.0;
 
-        // create all the temporary vectors which we need. Be aware that some of them
-        // actually point to the same object because they are not needed at the same time!
-        Vector y(x);
+        // set up references to the temporary vectors which we need. Be aware that some
+        // of them actually point to the same object because they are not needed at the
+        // same time!
+        Vector& y = ws.y;
         Vector& h(x);
         Vector& s(r);
-        Vector z(x);
+        Vector& z = ws.z;
         Vector& t(y);
+        y = 0.0;
+        z = 0.0;
         unsigned n = x.size();
 
-        for (; report_.iterations() < maxIterations_; report_.increment()) {
-            // rho_i = (r0hat,r_(i-1))
-            Scalar rho_i = scalarProduct_.dot(r0hat, r);
+        // (r0hat,r_(i-1)). for all but the first iteration, this is computed while
+        // updating the residual at the end of the previous iteration.
+        Scalar rho_i = scalarProduct_.dot(r0hat, r);
 
+        for (; report_.iterations() < maxIterations_; report_.increment()) {
             // beta = (rho_i/rho_(i-1))*(alpha/omega_(i-1))
             if (std::abs(rho) <= breakdownEps || std::abs(omega) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
@@ -209,13 +292,11 @@ public:
             // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
             // y = p
             for (unsigned i = 0; i < n; ++i) {
-                // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
-                auto tmp = v[i];
-                tmp *= omega;
-                tmp -= p[i];
-                tmp *= -beta;
-                p[i] = r[i];
-                p[i] += tmp;
+                auto& pi = p[i];
+                const auto& ri = r[i];
+                const auto& vi = v[i];
+                for (unsigned k = 0; k < blockSize; ++k)
+                    pi[k] = ri[k] + beta*(pi[k] - omega*vi[k]);
 
                 // y = p; not required because the precontioner overwrites y anyway...
                 // y[i] = p[i];
@@ -238,15 +319,17 @@ public:
             // h = x_(i-1) + alpha*y
             // s = r_(i-1) - alpha*v_i
             for (unsigned i = 0; i < n; ++i) {
-                auto tmp = y[i];
-                tmp *= alpha;
-                tmp += x[i];
-                h[i] = tmp;
-
-                //s[i] = r[i]; // not necessary because r and s are the same object
-                tmp = v[i];
-                tmp *= alpha;
-                s[i] -= tmp;
+                auto& hi = h[i];
+                auto& si = s[i];
+                const auto& yi = y[i];
+                const auto& vi = v[i];
+                for (unsigned k = 0; k < blockSize; ++k) {
+                    // h[i] = x[i] + alpha*y[i]; x and h are the same object
+                    hi[k] += alpha*yi[k];
+
+                    // s[i] = r[i] - alpha*v[i]; r and s are the same object
+                    si[k] -= alpha*vi[k];
+                }
             }
 
             // do convergence check and print terminal output
@@ -279,15 +362,29 @@ public:
             z = s;
             preconditioner_.apply(z, s);
 
-            // t = Az
-            t = z;
+            // t = Az. (the operator overwrites t, so it does not need to be initialized.)
             A_->apply(z, t);
 
-            // omega_i = (t*s)/(t*t)
-            denom = scalarProduct_.dot(t, t);
+            // omega_i = (t*s)/(t*t). both dot products are computed in the same pass
+            // and they are reduced over all processes at the same time.
+            Scalar dots[2] = { 0.0, 0.0 };
+            for (unsigned i = 0; i < n; ++i) {
+                if (!scalarProduct_.iAmMasterOf(i))
+                    continue;
+
+                const auto& ti = t[i];
+                const auto& si = s[i];
+                for (unsigned k = 0; k < blockSize; ++k) {
+                    dots[0] += ti[k]*ti[k];
+                    dots[1] += ti[k]*si[k];
+                }
+            }
+            scalarProduct_.sum(dots, /*numValues=*/2);
+
+            denom = dots[0];
             if (std::abs(denom) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
-            omega = scalarProduct_.dot(t, s)/denom;
+            omega = dots[1]/denom;
             if (std::abs(omega) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (stagnation detected)");
 
@@ -320,9 +417,27 @@ public:
             if (verbosity_ > 1)
                 convergenceCriterion_.print(1.0 + report_.iterations());
 
+            // this loop conflates the following operations:
+            //
             // r_i = s - omega*t
+            // rho_(i+1) = (r0hat,r_i)
+            //
             // r = s; // not necessary because r and s are the same object
-            r.axpy(/*a=*/-omega, /*y=*/t);
+            rho_i = 0.0;
+            for (unsigned i = 0; i < n; ++i) {
+                auto& ri = r[i];
+                const auto& ti = t[i];
+                for (unsigned k = 0; k < blockSize; ++k)
+                    ri[k] -= omega*ti[k];
+
+                if (!scalarProduct_.iAmMasterOf(i))
+                    continue;
+
+                const auto& r0hati = r0hat[i];
+                for (unsigned k = 0; k < blockSize; ++k)
+                    rho_i += r0hati[k]*ri[k];
+            }
+            scalarProduct_.sum(&rho_i, /*numValues=*/1);
         }
 
         report_.setConverged(false);
@@ -343,9 +458,12 @@ private:
 
     Preconditioner& preconditioner_;
     ConvergenceCriterion& convergenceCriterion_;
-    Dune::ScalarProduct<Vector>& scalarProduct_;
+    ScalarProduct& scalarProduct_;
     Ewoms::Linear::SolverReport report_;
 
+    Workspace* workspace_;
+    std::unique_ptr<Workspace> ownWorkspace_;
+
     unsigned maxIterations_;
     unsigned verbosity_;
 };
@@ -262,6 +262,66 @@ public:
         }
     }
 
+    /*!
+     * \brief Assign the overlapping matrix from a non-overlapping one and scale the
+     *        rows of the result.
+     *
+     * In contrast to assignFromNative(), this method copies the entries using a
+     * mapping from the entries of the native matrix to the ones of the overlapping
+     * matrix. This mapping is determined when the method is called for the first time,
+     * i.e., the sparsity pattern of the native matrix must stay the same for the
+     * lifetime of the overlapping matrix. The rows are multiplied by the respective
+     * entries of the weights on the fly, so no additional pass over the matrix is
+     * required for scaling.
+     *
+     * \param nativeMatrix The non-overlapping matrix
+     * \param rowWeights A vector with the scaling factors of each domestic row
+     */
+    template <class NativeBCRSMatrix, class RowWeightVector>
+    void assignFromNativeWeighted(const NativeBCRSMatrix& nativeMatrix,
+                                  const RowWeightVector& rowWeights)
+    {
+        if (nativeRowOffsets_.size() != nativeMatrix.N() + 1
+            || nativeEntryMap_.size() != nativeMatrix.nonzeroes())
+            buildNativeEntryMap_(nativeMatrix);
+
+        // the entries which do not correspond to any entry of the native matrix must be
+        // reset. all others are overwritten below.
+        for (auto* entry : unmappedEntries_)
+            *entry = 0.0;
+
+        int numNativeRows = static_cast<int>(nativeMatrix.N());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx) {
+            unsigned rowIdx = static_cast<unsigned>(nativeRowIdx);
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(rowIdx));
+            if (domesticRowIdx < 0)
+                continue; // row corresponds to a black-listed entry
+
+            const auto& weights = rowWeights[static_cast<unsigned>(domesticRowIdx)];
+            size_t entryIdx = nativeRowOffsets_[rowIdx];
+            auto nativeColIt = nativeMatrix[rowIdx].begin();
+            const auto& nativeColEndIt = nativeMatrix[rowIdx].end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++entryIdx) {
+                block_type* dest = nativeEntryMap_[entryIdx];
+                if (!dest)
+                    continue;
+
+                // we need to copy the block matrices manually since it seems that (at
+                // least some versions of) Dune have an endless recursion bug when
+                // assigning dense matrices of different field type
+                const auto& src = *nativeColIt;
+                for (unsigned i = 0; i < src.rows; ++i) {
+                    for (unsigned j = 0; j < src.cols; ++j) {
+                        (*dest)[i][j] = static_cast<field_type>(src[i][j])*weights[i];
+                    }
+                }
+            }
+        }
+    }
+
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
@@ -664,6 +724,54 @@ private:
 #endif // HAVE_MPI
     }
 
+    // determine the entries of the overlapping matrix which correspond to the entries of
+    // a native matrix. this mirrors the logic of assignFromNative()
+    template <class NativeBCRSMatrix>
+    void buildNativeEntryMap_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        nativeRowOffsets_.resize(nativeMatrix.N() + 1);
+        nativeEntryMap_.resize(nativeMatrix.nonzeroes());
+
+        std::set<const block_type*> mappedEntries;
+        size_t entryIdx = 0;
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            nativeRowOffsets_[nativeRowIdx] = entryIdx;
+
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++entryIdx) {
+                nativeEntryMap_[entryIdx] = nullptr;
+                if (domesticRowIdx < 0)
+                    continue; // row corresponds to a black-listed entry
+
+                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+                if (domesticColIdx < 0)
+                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+                if (domesticColIdx < 0)
+                    continue;
+
+                block_type* dest =
+                    &(*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
+                nativeEntryMap_[entryIdx] = dest;
+                mappedEntries.insert(dest);
+            }
+        }
+        nativeRowOffsets_[nativeMatrix.N()] = entryIdx;
+
+        unmappedEntries_.clear();
+        for (unsigned rowIdx = 0; rowIdx < this->N(); ++rowIdx) {
+            auto colIt = (*this)[rowIdx].begin();
+            const auto& colEndIt = (*this)[rowIdx].end();
+            for (; colIt != colEndIt; ++colIt) {
+                block_type* entry = &(*colIt);
+                if (mappedEntries.count(entry) == 0)
+                    unmappedEntries_.push_back(entry);
+            }
+        }
+    }
+
     void globalToDomesticBuff_(MpiBuffer<Index>& idxBuff)
     {
         for (unsigned i = 0; i < idxBuff.size(); ++i)
@@ -674,6 +782,12 @@ private:
     Entries entries_;
     std::shared_ptr<Overlap> overlap_;
 
+    // the mapping of the entries of the native matrix to the ones of the overlapping
+    // matrix used by assignFromNativeWeighted()
+    std::vector<size_t> nativeRowOffsets_;
+    std::vector<block_type*> nativeEntryMap_;
+    std::vector<block_type*> unmappedEntries_;
+
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesSendBuff_;
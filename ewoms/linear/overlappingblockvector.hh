@@ -37,6 +37,8 @@
 
 #include <memory>
 #include <map>
+#include <vector>
+#include <cassert>
 #include <iostream>
 
 namespace Ewoms {
@@ -173,26 +175,31 @@ public:
      */
     void sync()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            sendEntries_(peerRank);
-        }
+        syncBegin();
+        syncEnd();
+    }
 
-        // recieve all entries to the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            receiveFromMaster_(peerRank);
-        }
+    /*!
+     * \brief Start to syncronize all values of the block vector from their master
+     *        process.
+     *
+     * This sends the entries which are required by the peer processes and posts the
+     * receive operations for the entries of the peers, but it does not wait for any
+     * communication. The entries which are sent to peers are copied, so the vector may
+     * be modified until syncEnd() is called. The entries which are received from peers
+     * are overwritten by syncEnd(), though.
+     */
+    void syncBegin()
+    { beginExchange_(); }
 
-        // wait until we have send everything
-        waitSendFinished_();
-    }
+    /*!
+     * \brief Finish syncronizing the values of the block vector which has been started
+     *        using syncBegin().
+     *
+     * The peers are processed in the order in which their data arrives.
+     */
+    void syncEnd()
+    { finishExchange_(ReceiveMode::FromMaster); }
 
     /*!
      * \brief Syncronize all values of the block vector by adding up
@@ -200,25 +207,8 @@ public:
      */
     void syncAdd()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            sendEntries_(peerRank);
-        }
-
-        // recieve all entries to the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            receiveAdd_(peerRank);
-        }
-
-        // wait until we have send everything
-        waitSendFinished_();
+        beginExchange_();
+        finishExchange_(ReceiveMode::Add);
     }
 
     /*!
@@ -227,26 +217,8 @@ public:
      */
     void syncAddBorder()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            sendEntries_(peerRank);
-        }
-
-        // recieve all entries to the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            receiveAddBorder_(peerRank);
-        }
-
-        // wait until we have send everything
-        waitSendFinished_();
-
+        beginExchange_();
+        finishExchange_(ReceiveMode::AddBorder);
     }
 
     void print() const
@@ -258,6 +230,14 @@ public:
     }
 
 private:
+    // specifies how the entries received from a peer are incorporated
+    enum class ReceiveMode
+    {
+        FromMaster,
+        Add,
+        AddBorder
+    };
+
     void createBuffers_()
     {
 #if HAVE_MPI
@@ -336,6 +316,69 @@ private:
 #endif // HAVE_MPI
     }
 
+    void beginExchange_()
+    {
+        typename PeerSet::const_iterator peerIt;
+        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
+
+        // post the receive operations first, so that the data of the peers does not
+        // need to be buffered by MPI
+        peerIt = overlap_->peerSet().begin();
+        for (; peerIt != peerEndIt; ++peerIt) {
+            ProcessRank peerRank = *peerIt;
+            valuesRecvBuff_[peerRank]->receiveAsync(peerRank);
+        }
+
+        // send all entries to all peers
+        peerIt = overlap_->peerSet().begin();
+        for (; peerIt != peerEndIt; ++peerIt) {
+            ProcessRank peerRank = *peerIt;
+            sendEntries_(peerRank);
+        }
+    }
+
+    void finishExchange_(ReceiveMode mode)
+    {
+#if HAVE_MPI
+        const auto& peerSet = overlap_->peerSet();
+        recvRequests_.clear();
+        recvPeers_.clear();
+        auto peerIt = peerSet.begin();
+        const auto& peerEndIt = peerSet.end();
+        for (; peerIt != peerEndIt; ++peerIt) {
+            ProcessRank peerRank = *peerIt;
+            recvRequests_.push_back(valuesRecvBuff_[peerRank]->request());
+            recvPeers_.push_back(peerRank);
+        }
+
+        // incorporate the entries of the peers in the order in which they arrive
+        for (size_t i = 0; i < recvRequests_.size(); ++i) {
+            int requestIdx;
+            MPI_Waitany(static_cast<int>(recvRequests_.size()),
+                        recvRequests_.data(),
+                        &requestIdx,
+                        MPI_STATUS_IGNORE);
+            assert(requestIdx != MPI_UNDEFINED);
+
+            ProcessRank peerRank = recvPeers_[static_cast<unsigned>(requestIdx)];
+            switch (mode) {
+            case ReceiveMode::FromMaster:
+                receiveFromMaster_(peerRank);
+                break;
+            case ReceiveMode::Add:
+                receiveAdd_(peerRank);
+                break;
+            case ReceiveMode::AddBorder:
+                receiveAddBorder_(peerRank);
+                break;
+            }
+        }
+#endif // HAVE_MPI
+
+        // wait until we have send everything
+        waitSendFinished_();
+    }
+
     void sendEntries_(ProcessRank peerRank)
     {
         // copy the values into the send buffer
@@ -363,12 +406,9 @@ private:
     void receiveFromMaster_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // copy them into the block vector
+        // copy the values received from the peer into the block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
             Index domRowIdx = indices[j];
             if (overlap_->masterRank(domRowIdx) == peerRank) {
@@ -380,10 +420,7 @@ private:
     void receiveAddBorder_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -398,10 +435,7 @@ private:
     void receiveAdd_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -416,6 +450,12 @@ private:
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
 
+#if HAVE_MPI
+    // scratch space for the requests of the pending receive operations
+    std::vector<MPI_Request> recvRequests_;
+    std::vector<ProcessRank> recvPeers_;
+#endif // HAVE_MPI
+
     const Overlap *overlap_;
 };
 
@@ -27,9 +27,13 @@
 #ifndef EWOMS_OVERLAPPING_OPERATOR_HH
 #define EWOMS_OVERLAPPING_OPERATOR_HH
 
+#include "overlaptypes.hh"
+
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <vector>
+
 namespace Ewoms {
 namespace Linear {
 
@@ -48,7 +52,29 @@ public:
     typedef typename domain_type::field_type field_type;
 
     OverlappingOperator(const OverlappingMatrix& A) : A_(A)
-    {}
+    {
+        // split the rows into the ones which need to be send to peer processes and the
+        // remaining ones. the former are computed first, so that their communication
+        // can proceed while the latter are computed.
+        const Overlap& overlap = A_.overlap();
+        std::vector<bool> isSendRow(A_.N(), false);
+        const auto& peerSet = overlap.peerSet();
+        for (auto peerIt = peerSet.begin(); peerIt != peerSet.end(); ++peerIt) {
+            ProcessRank peerRank = *peerIt;
+            size_t numEntries = overlap.foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < numEntries; ++i) {
+                Index domRowIdx = overlap.foreignOverlapOffsetToDomesticIdx(peerRank, i);
+                isSendRow[static_cast<unsigned>(domRowIdx)] = true;
+            }
+        }
+
+        for (unsigned rowIdx = 0; rowIdx < A_.N(); ++rowIdx) {
+            if (isSendRow[rowIdx])
+                sendRows_.push_back(rowIdx);
+            else
+                interiorRows_.push_back(rowIdx);
+        }
+    }
 
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
@@ -62,16 +88,34 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (sendRows_.empty()) {
+            A_.mv(x, y);
+            y.sync();
+            return;
+        }
+
+        // compute the rows required by the peers, then overlap their communication
+        // with the computation of the remaining ones
+        mvRows_(sendRows_, x, y);
+        y.syncBegin();
+        mvRows_(interiorRows_, x, y);
+        y.syncEnd();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (sendRows_.empty()) {
+            A_.usmv(alpha, x, y);
+            y.sync();
+            return;
+        }
+
+        usmvRows_(sendRows_, alpha, x, y);
+        y.syncBegin();
+        usmvRows_(interiorRows_, alpha, x, y);
+        y.syncEnd();
     }
 
     //! returns the matrix
@@ -82,7 +126,42 @@ public:
     { return A_.overlap(); }
 
 private:
+    // y_i = (A x)_i for a subset of the rows
+    void mvRows_(const std::vector<unsigned>& rows, const DomainVector& x, RangeVector& y) const
+    {
+        for (unsigned rowIdx : rows) {
+            auto& yi = y[rowIdx];
+            yi = 0.0;
+
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                colIt->umv(x[colIt.index()], yi);
+        }
+    }
+
+    // y_i += alpha*(A x)_i for a subset of the rows
+    void usmvRows_(const std::vector<unsigned>& rows,
+                   field_type alpha,
+                   const DomainVector& x,
+                   RangeVector& y) const
+    {
+        for (unsigned rowIdx : rows) {
+            auto& yi = y[rowIdx];
+
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                colIt->usmv(alpha, x[colIt.index()], yi);
+        }
+    }
+
     const OverlappingMatrix& A_;
+
+    std::vector<unsigned> sendRows_;
+    std::vector<unsigned> interiorRows_;
 };
 
 } // namespace Linear
@@ -31,6 +31,8 @@
 #include <dune/common/parallel/mpihelper.hh>
 #include <dune/istl/scalarproducts.hh>
 
+#include <vector>
+
 namespace Ewoms {
 namespace Linear {
 
@@ -62,7 +64,12 @@ public:
 
     OverlappingScalarProduct(const Overlap& overlap)
         : overlap_(overlap), comm_( Dune::MPIHelper::getCollectiveCommunication() )
-    {}
+    {
+        size_t numDomestic = overlap_.numDomestic();
+        isMaster_.resize(numDomestic);
+        for (unsigned domesticIdx = 0; domesticIdx < numDomestic; ++domesticIdx)
+            isMaster_[domesticIdx] = overlap_.iAmMasterOf(static_cast<int>(domesticIdx));
+    }
 
     field_type dot(const OverlappingBlockVector& x,
                    const OverlappingBlockVector& y) override
@@ -70,7 +77,7 @@ public:
         field_type sum = 0;
         size_t numLocal = overlap_.numLocal();
         for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
-            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
+            if (isMaster_[localIdx])
                 sum += x[localIdx] * y[localIdx];
         }
 
@@ -78,12 +85,31 @@ public:
         return comm_.sum( sum );
     }
 
+    /*!
+     * \brief Returns true iff the current process is responsible for a domestic index
+     *        in the scalar product.
+     *
+     * Solvers can use this to compute process-local contributions to scalar products
+     * within their own loops.
+     */
+    bool iAmMasterOf(unsigned domesticIdx) const
+    { return isMaster_[domesticIdx]; }
+
+    /*!
+     * \brief Sum up process-local contributions to scalar products over all processes.
+     *
+     * All values are reduced using a single collective operation.
+     */
+    void sum(field_type* values, int numValues) const
+    { comm_.sum(values, numValues); }
+
     real_type norm(const OverlappingBlockVector& x) override
     { return std::sqrt(dot(x, x)); }
 
 private:
     const Overlap& overlap_;
     const CollectiveCommunication comm_;
+    std::vector<unsigned char> isMaster_;
 };
 
 } // namespace Linear
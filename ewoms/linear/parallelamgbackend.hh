@@ -129,7 +129,8 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
 
     typedef BiCGStabSolver<ParallelOperator,
                            OverlappingVector,
-                           AMG> RawLinearSolver;
+                           AMG,
+                           ParallelScalarProduct> RawLinearSolver;
 
 public:
     ParallelAmgBackend(const Simulator& simulator)
@@ -201,6 +202,7 @@ protected:
         bicgstabSolver->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
         bicgstabSolver->setLinearOperator(&parOperator);
         bicgstabSolver->setRhs(this->overlappingb_);
+        bicgstabSolver->setWorkspace(&workspace_);
 
         return bicgstabSolver;
     }
@@ -211,6 +213,15 @@ protected:
     void cleanupSolver_()
     { /* nothing to do */ }
 
+    void cleanup_()
+    {
+        // the temporary vectors of the solver refer to the overlap of the linear
+        // system, so they must be recreated if the overlap is.
+        workspace_.clear();
+
+        ParentType::cleanup_();
+    }
+
 #if HAVE_MPI
     template <class ParallelIndexSet>
     void setupAmgIndexSet_(const Overlap& overlap, ParallelIndexSet& istlIndices)
@@ -287,6 +298,7 @@ protected:
     }
 
     std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    BiCGStabWorkspace<OverlappingVector> workspace_;
 
     std::shared_ptr<FineOperator> fineOperator_;
     std::shared_ptr<AMG> amg_;
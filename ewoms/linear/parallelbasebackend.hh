@@ -44,6 +44,7 @@
 #include <dune/common/fvector.hh>
 
 #include <sstream>
+#include <vector>
 #include <memory>
 #include <iostream>
 
@@ -203,7 +204,7 @@ public:
      *        equations the next time it is called.
      */
     void eraseMatrix()
-    { cleanup_(); }
+    { asImp_().cleanup_(); }
 
     void prepareMatrix(const Matrix& M)
     {
@@ -213,8 +214,9 @@ public:
 
         // copy the interior values of the non-overlapping linear system of
         // equations to the overlapping one. On ther border, we add up
-        // the values of all processes (using the assignAdd() methods)
-        overlappingMatrix_->assignFromNative(M);
+        // the values of all processes (using the assignAdd() methods). The
+        // equation weights are applied while copying.
+        overlappingMatrix_->assignFromNativeWeighted(M, rowWeights_);
 
         asImp_().rescale_();
 
@@ -315,27 +317,42 @@ protected:
         overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
         overlappingx_ = new OverlappingVector(*overlappingb_);
 
+        // the weights of the equations only depend on the degree of freedom and the
+        // equation index, so they only need to be determined if the grid changes
+        updateRowWeights_();
+
         // writeOverlapToVTK_();
     }
 
-    void rescale_()
+    void updateRowWeights_()
     {
         const auto& overlap = overlappingMatrix_->overlap();
-        for (unsigned domesticRowIdx = 0; domesticRowIdx < overlap.numLocal(); ++domesticRowIdx) {
-            Index nativeRowIdx = overlap.domesticToNative(static_cast<Index>(domesticRowIdx));
-            auto& row = (*overlappingMatrix_)[domesticRowIdx];
-
-            auto colIt = row.begin();
-            const auto& colEndIt = row.end();
-            for (; colIt != colEndIt; ++ colIt) {
-                auto& entry = *colIt;
-                for (unsigned i = 0; i < entry.rows; ++i)
-                    entry[i] *= simulator_.model().eqWeight(nativeRowIdx, i);
+        size_t numDomestic = overlap.numDomestic();
+        rowWeights_.resize(numDomestic);
+        for (unsigned domesticRowIdx = 0; domesticRowIdx < numDomestic; ++domesticRowIdx) {
+            auto& weights = rowWeights_[domesticRowIdx];
+            if (domesticRowIdx >= overlap.numLocal()) {
+                // rows which are not local to the process are not scaled
+                weights = 1.0;
+                continue;
             }
 
+            Index nativeRowIdx = overlap.domesticToNative(static_cast<Index>(domesticRowIdx));
+            for (unsigned i = 0; i < weights.size(); ++i)
+                weights[i] = simulator_.model().eqWeight(static_cast<unsigned>(nativeRowIdx), i);
+        }
+    }
+
+    // scale the right hand side using the equation weights. (the matrix is already
+    // scaled by assignFromNativeWeighted().)
+    void rescale_()
+    {
+        const auto& overlap = overlappingMatrix_->overlap();
+        for (unsigned domesticRowIdx = 0; domesticRowIdx < overlap.numLocal(); ++domesticRowIdx) {
+            const auto& weights = rowWeights_[domesticRowIdx];
             auto& rhsEntry = (*overlappingb_)[domesticRowIdx];
             for (unsigned i = 0; i < rhsEntry.size(); ++i)
-                rhsEntry[i] *= simulator_.model().eqWeight(nativeRowIdx, i);
+                rhsEntry[i] *= weights[i];
         }
     }
 
@@ -424,6 +441,9 @@ protected:
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
+    // the weights of the equations of each domestic row of the linear system
+    std::vector<typename OverlappingVector::block_type> rowWeights_;
+
     PreconditionerWrapper precWrapper_;
 };
 }} // namespace Linear, Ewoms
@@ -95,7 +95,8 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 
     typedef BiCGStabSolver<ParallelOperator,
                            OverlappingVector,
-                           ParallelPreconditioner> RawLinearSolver;
+                           ParallelPreconditioner,
+                           ParallelScalarProduct> RawLinearSolver;
 
 public:
     ParallelBiCGStabSolverBackend(const Simulator& simulator)
@@ -139,6 +140,7 @@ protected:
         bicgstabSolver->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
         bicgstabSolver->setLinearOperator(&parOperator);
         bicgstabSolver->setRhs(this->overlappingb_);
+        bicgstabSolver->setWorkspace(&workspace_);
 
         return bicgstabSolver;
     }
@@ -149,7 +151,17 @@ protected:
     void cleanupSolver_()
     { /* nothing to do */ }
 
+    void cleanup_()
+    {
+        // the temporary vectors of the solver refer to the overlap of the linear
+        // system, so they must be recreated if the overlap is.
+        workspace_.clear();
+
+        ParentType::cleanup_();
+    }
+
     std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    BiCGStabWorkspace<OverlappingVector> workspace_;
 };
 
 }} // namespace Linear, Ewoms
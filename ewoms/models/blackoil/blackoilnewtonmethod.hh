@@ -34,6 +34,10 @@
 
 #include <opm/material/common/Unused.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace Ewoms {
 
 /*!
@@ -53,12 +57,13 @@ class BlackOilNewtonMethod : public GET_PROP_TYPE(TypeTag, DiscNewtonMethod)
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Linearizer) Linearizer;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
 
     static const unsigned numEq = GET_PROP_VALUE(TypeTag, NumEq);
 
 public:
     BlackOilNewtonMethod(Simulator& simulator) : ParentType(simulator)
-    { }
+    { computeSolutionChange_ = false; }
 
     /*!
      * \brief Register all run-time parameters for the immiscible model.
@@ -85,6 +90,14 @@ protected:
     void beginIteration_()
     {
         numPriVarsSwitched_ = 0;
+
+        // the change of the solution is only determined if the time step controller
+        // makes use of it
+        computeSolutionChange_ = this->problem().timeStepController().needsSolutionChange();
+        threadMaxSolutionChange_.resize(ThreadManager::maxThreads());
+        for (auto& threadChange : threadMaxSolutionChange_)
+            threadChange.value = 0.0;
+
         ParentType::beginIteration_();
     }
 
@@ -138,6 +151,16 @@ protected:
             throw Opm::NumericalIssue("A process did not succeed in adapting the primary variables");
 
         numPriVarsSwitched_ = comm.sum(numPriVarsSwitched_);
+
+        // the time step controller uses the change of the solution compared to the
+        // beginning of the time step. the per-DOF changes were determined while
+        // updating the primary variables.
+        if (computeSolutionChange_) {
+            Scalar maxChange = 0.0;
+            for (const auto& threadChange : threadMaxSolutionChange_)
+                maxChange = std::max(maxChange, threadChange.value);
+            this->solutionChange_ = comm.max(maxChange);
+        }
     }
 
     /*!
@@ -182,15 +205,64 @@ protected:
             nextValue[eqIdx] = currentValue[eqIdx] - delta;
         }
 
-        // switch the new primary variables to something which is physically meaningful
-        if (nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx))
+        // switch the new primary variables to something which is physically meaningful.
+        // (this method is called concurrently for distinct DOFs.)
+        if (nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx)) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
             ++ numPriVarsSwitched_;
+        }
+
+        if (computeSolutionChange_) {
+            Scalar& threadMaxChange = threadMaxSolutionChange_[ThreadManager::threadId()].value;
+            threadMaxChange = std::max(threadMaxChange, dofSolutionChange_(globalDofIdx, nextValue));
+        }
 
         nextValue.checkDefined();
     }
 
+    /*!
+     * \brief Returns the change of the saturations and of the relative pressure of a
+     *        DOF compared to the solution at the beginning of the time step.
+     *
+     * Primary variables are only compared if their meaning did not change.
+     */
+    Scalar dofSolutionChange_(unsigned globalDofIdx, const PrimaryVariables& nextValue) const
+    {
+        const PrimaryVariables& oldValue = this->model().solution(/*timeIdx=*/1)[globalDofIdx];
+
+        bool sameMeaning = nextValue.primaryVarsMeaning() == oldValue.primaryVarsMeaning();
+        Scalar maxChange = 0.0;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+            Scalar change = 0.0;
+            if (pvIdx == Indices::waterSaturationIdx)
+                change = std::abs(nextValue[pvIdx] - oldValue[pvIdx]);
+            else if (pvIdx == Indices::pressureSwitchIdx && sameMeaning)
+                change = std::abs(nextValue[pvIdx] - oldValue[pvIdx])
+                    / std::max<Scalar>(std::abs(oldValue[pvIdx]), 1e-30);
+            else if (pvIdx == Indices::compositionSwitchIdx
+                     && sameMeaning
+                     && nextValue.primaryVarsMeaning() == PrimaryVariables::Sw_po_Sg)
+                change = std::abs(nextValue[pvIdx] - oldValue[pvIdx]);
+
+            maxChange = std::max(maxChange, change);
+        }
+
+        return maxChange;
+    }
+
 private:
+    // the maximum of the solution change is determined by each thread separately. the
+    // entries are aligned to cache lines to avoid false sharing.
+    struct alignas(64) ThreadSolutionChange
+    {
+        Scalar value;
+    };
+
     int numPriVarsSwitched_;
+    bool computeSolutionChange_;
+    std::vector<ThreadSolutionChange> threadMaxSolutionChange_;
 };
 } // namespace Ewoms
 
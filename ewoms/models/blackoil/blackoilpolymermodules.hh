@@ -51,6 +51,10 @@
 
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
 #include <string>
 
 namespace Ewoms {
@@ -695,18 +699,14 @@ public:
         // Z = (1 + (P - 1) * M(v) ) / P
         // where M(v) is computed from user input
         // and P = viscosityMultiplier
+        //
+        // the logarithmic multipliers are interpolated linearly in the logarithmic
+        // velocity space. since they depend on the viscosity multiplier, they are
+        // computed on the fly for the segments which are actually needed.
         const std::vector<Scalar>& shearEffectRefMultiplier = plyshlogShearEffectRefMultiplier_[pvtnumRegionIdx];
-        size_t numTableEntries = shearEffectRefLogVelocity.size();
-        assert(shearEffectRefMultiplier.size() == numTableEntries);
-
-        std::vector<Scalar> shearEffectMultiplier(numTableEntries, 1.0);
-        for (size_t i = 0; i < numTableEntries; ++i) {
-            shearEffectMultiplier[i] = (1.0 + (viscosityMultiplier - 1.0)*shearEffectRefMultiplier[i]) / viscosityMultiplier;
-            shearEffectMultiplier[i] = Opm::log(shearEffectMultiplier[i]);
-        }
-        // store the logarithmic velocity and logarithmic multipliers in a table for easy look up and
-        // linear interpolation in the logarithmic space.
-        TabulatedFunction logShearEffectMultiplier = TabulatedFunction(numTableEntries, shearEffectRefLogVelocity, shearEffectMultiplier, /*bool sortInputs =*/ false );
+        LogShearEffectMultiplier_ logShearEffectMultiplier(shearEffectRefLogVelocity,
+                                                          shearEffectRefMultiplier,
+                                                          viscosityMultiplier);
 
         // Find sheared velocity (v) that satisfies
         // F = log(v) + log (Z) - log(v0) = 0;
@@ -714,11 +714,11 @@ public:
         // Set up the function
         // u = log(v)
         auto F = [&logShearEffectMultiplier, &v0AbsLog](const Evaluation& u) {
-            return u + logShearEffectMultiplier.eval(u, true) - v0AbsLog;
+            return u + logShearEffectMultiplier.eval(u) - v0AbsLog;
         };
         // and its derivative
         auto dF = [&logShearEffectMultiplier](const Evaluation& u) {
-            return 1 + logShearEffectMultiplier.evalDerivative(u, true);
+            return 1 + logShearEffectMultiplier.evalDerivative(u);
         };
 
         // Solve F = 0 using Newton
@@ -739,7 +739,7 @@ public:
         }
 
         // return the shear factor
-        return Opm::exp( logShearEffectMultiplier.eval(u, /*extrapolate=*/true) );
+        return Opm::exp( logShearEffectMultiplier.eval(u) );
 
     }
 
@@ -747,6 +747,75 @@ public:
 
 
 private:
+    // the logarithm of the shear effect multiplier Z as a piecewise linear function of
+    // the logarithm of the velocity for a given viscosity multiplier, i.e., the same as
+    // a Tabulated1DFunction which extrapolates. the values at the sampling points are
+    // only computed for the segment which is currently used, so that evaluating the
+    // function does not require to allocate any memory.
+    class LogShearEffectMultiplier_
+    {
+    public:
+        LogShearEffectMultiplier_(const std::vector<Scalar>& logVelocity,
+                                  const std::vector<Scalar>& refMultiplier,
+                                  Scalar viscosityMultiplier)
+            : logVelocity_(logVelocity)
+            , refMultiplier_(refMultiplier)
+            , viscosityMultiplier_(viscosityMultiplier)
+            , segIdx_(std::numeric_limits<size_t>::max())
+        {
+            assert(logVelocity_.size() == refMultiplier_.size());
+            assert(logVelocity_.size() >= 2);
+        }
+
+        template <class Evaluation>
+        Evaluation eval(const Evaluation& u)
+        {
+            updateSegment_(Opm::scalarValue(u));
+            return y0_ + (u - x0_)*slope_;
+        }
+
+        template <class Evaluation>
+        Scalar evalDerivative(const Evaluation& u)
+        {
+            updateSegment_(Opm::scalarValue(u));
+            return slope_;
+        }
+
+    private:
+        void updateSegment_(Scalar u)
+        {
+            // find the segment which contains u. values outside of the sampling range
+            // use the first or the last segment
+            size_t numSamples = logVelocity_.size();
+            size_t segIdx =
+                static_cast<size_t>(std::upper_bound(logVelocity_.begin(), logVelocity_.end(), u)
+                                    - logVelocity_.begin());
+            segIdx = std::min(std::max<size_t>(segIdx, 1), numSamples - 1) - 1;
+            if (segIdx == segIdx_)
+                return;
+
+            segIdx_ = segIdx;
+            x0_ = logVelocity_[segIdx];
+            y0_ = logMultiplier_(segIdx);
+            slope_ = (logMultiplier_(segIdx + 1) - y0_)/(logVelocity_[segIdx + 1] - x0_);
+        }
+
+        Scalar logMultiplier_(size_t sampleIdx) const
+        {
+            Scalar P = viscosityMultiplier_;
+            return std::log((1.0 + (P - 1.0)*refMultiplier_[sampleIdx]) / P);
+        }
+
+        const std::vector<Scalar>& logVelocity_;
+        const std::vector<Scalar>& refMultiplier_;
+        Scalar viscosityMultiplier_;
+
+        size_t segIdx_;
+        Scalar x0_;
+        Scalar y0_;
+        Scalar slope_;
+    };
+
     static std::vector<Scalar> plyrockDeadPoreVolume_;
     static std::vector<Scalar> plyrockResidualResistanceFactor_;
     static std::vector<Scalar> plyrockRockDensityFactor_;
@@ -208,7 +208,7 @@ public:
 
         storage = 0;
 
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->elementChunks());
         OmpMutex addMutex;
 #ifdef _OPENMP
 #pragma omp parallel
@@ -42,6 +42,7 @@
 
 #include <opm/material/common/Exceptions.hpp>
 
+#include <stdexcept>
 #include <string>
 
 namespace Ewoms {
@@ -135,6 +136,20 @@ public:
         Ewoms::VtkDiscreteFractureModule<TypeTag>::registerParameters();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        // the fracture topology is queried for every degree of freedom and every face,
+        // so this is only checked once here
+        if (!this->simulator_.problem().fractureMapper().isFinalized())
+            throw std::logic_error("The fracture mapper must be finalized before the "
+                                   "discrete fracture model is used");
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::name
      */
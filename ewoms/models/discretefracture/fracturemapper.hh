@@ -30,39 +30,31 @@
 #include <ewoms/common/propertysystem.hh>
 
 #include <algorithm>
-#include <set>
+#include <cassert>
+#include <utility>
+#include <vector>
 
 namespace Ewoms {
 
 /*!
  * \ingroup DiscreteFractureModel
  * \brief Stores the topology of fractures.
+ *
+ * The fracture edges are first collected using addFractureEdge(). Before the topology
+ * can be queried, finalize() must be called which converts it into a flat index: a
+ * bitmap of the fracture vertices and a compressed row storage list of the fracture
+ * edges which are adjacent to each vertex. The queries are thus cheap and can be used
+ * concurrently by multiple threads.
  */
 template <class TypeTag>
 class FractureMapper
 {
-    struct FractureEdge
-    {
-        FractureEdge(unsigned edgeVertex1Idx, unsigned edgeVertex2Idx)
-            : i_(std::min(edgeVertex1Idx, edgeVertex2Idx)),
-              j_(std::max(edgeVertex1Idx, edgeVertex2Idx))
-        {}
-
-        bool operator<(const FractureEdge& e) const
-        { return i_ < e.i_ || (i_ == e.i_ && j_ < e.j_); }
-
-        bool operator==(const FractureEdge& e) const
-        { return i_ == e.i_ && j_ == e.j_; }
-
-        unsigned i_;
-        unsigned j_;
-    };
-
 public:
     /*!
      * \brief Constructor
      */
     FractureMapper()
+        : finalized_(true)
     {}
 
     /*!
@@ -73,18 +65,78 @@ public:
      */
     void addFractureEdge(unsigned vertexIdx1, unsigned vertexIdx2)
     {
-        fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
-        fractureVertices_.insert(vertexIdx1);
-        fractureVertices_.insert(vertexIdx2);
+        edges_.emplace_back(vertexIdx1, vertexIdx2);
+        finalized_ = false;
     }
 
+    /*!
+     * \brief Builds the index which is used by the queries from the fracture edges
+     *        which have been added so far.
+     *
+     * This method must be called after the last call to addFractureEdge().
+     */
+    void finalize()
+    {
+        unsigned numVertices = 0;
+        for (const auto& edge : edges_)
+            numVertices = std::max(numVertices, std::max(edge.first, edge.second) + 1);
+
+        isFractureVertex_.assign(numVertices, 0);
+        neighborOffsets_.assign(numVertices + 1, 0);
+
+        // count the fracture edges adjacent to each vertex. edges which have been
+        // added multiple times are removed below.
+        for (const auto& edge : edges_) {
+            isFractureVertex_[edge.first] = 1;
+            isFractureVertex_[edge.second] = 1;
+            ++ neighborOffsets_[edge.first + 1];
+            ++ neighborOffsets_[edge.second + 1];
+        }
+        for (unsigned vertexIdx = 0; vertexIdx < numVertices; ++ vertexIdx)
+            neighborOffsets_[vertexIdx + 1] += neighborOffsets_[vertexIdx];
+
+        std::vector<unsigned> neighbors(neighborOffsets_[numVertices]);
+        std::vector<unsigned> fillPos(neighborOffsets_.begin(), neighborOffsets_.end() - 1);
+        for (const auto& edge : edges_) {
+            neighbors[fillPos[edge.first]++] = edge.second;
+            neighbors[fillPos[edge.second]++] = edge.first;
+        }
+
+        // sort the neighbors of each vertex and remove duplicates
+        neighbors_.clear();
+        neighbors_.reserve(neighbors.size());
+        for (unsigned vertexIdx = 0; vertexIdx < numVertices; ++ vertexIdx) {
+            auto beginIt = neighbors.begin() + neighborOffsets_[vertexIdx];
+            auto endIt = neighbors.begin() + neighborOffsets_[vertexIdx + 1];
+            std::sort(beginIt, endIt);
+            endIt = std::unique(beginIt, endIt);
+
+            neighborOffsets_[vertexIdx] = static_cast<unsigned>(neighbors_.size());
+            neighbors_.insert(neighbors_.end(), beginIt, endIt);
+        }
+        neighborOffsets_[numVertices] = static_cast<unsigned>(neighbors_.size());
+        neighbors_.shrink_to_fit();
+
+        finalized_ = true;
+    }
+
+    /*!
+     * \brief Returns true iff the fracture topology can be queried, i.e., if finalize()
+     *        has been called after the last fracture edge was added.
+     */
+    bool isFinalized() const
+    { return finalized_; }
+
     /*!
      * \brief Returns true iff a fracture cuts through a given vertex.
      *
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    {
+        assert(finalized_);
+        return vertexIdx < isFractureVertex_.size() && isFractureVertex_[vertexIdx];
+    }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -94,13 +146,24 @@ public:
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
-        FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        if (!isFractureVertex(vertex1Idx) || !isFractureVertex(vertex2Idx))
+            return false;
+
+        // a vertex is only adjacent to a handful of fracture edges, so a linear search
+        // is the fastest option here
+        auto beginIt = neighbors_.begin() + neighborOffsets_[vertex1Idx];
+        auto endIt = neighbors_.begin() + neighborOffsets_[vertex1Idx + 1];
+        return std::find(beginIt, endIt, vertex2Idx) != endIt;
     }
 
 private:
-    std::set<FractureEdge> fractureEdges_;
-    std::set<unsigned> fractureVertices_;
+    // all fracture edges which have been added, including duplicates
+    std::vector<std::pair<unsigned, unsigned> > edges_;
+    bool finalized_;
+
+    std::vector<unsigned char> isFractureVertex_;
+    std::vector<unsigned> neighborOffsets_;
+    std::vector<unsigned> neighbors_;
 };
 
 } // namespace Ewoms
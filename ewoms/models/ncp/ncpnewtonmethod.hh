@@ -82,7 +82,7 @@ protected:
 
         // calculate the error as the maximum weighted tolerance of
         // the solution's residual
-        this->error_ = 0;
+        Scalar localError = 0;
         for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
             // do not consider auxiliary DOFs for the error
             if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
@@ -98,21 +98,14 @@ protected:
             for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
                 if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
                     continue;
-                this->error_ =
+                localError =
                     std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
+                             localError);
             }
         }
 
         // take the other processes into account
-        this->error_ = this->comm_.max(this->error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (this->error_ > EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))
-            throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(this->error_))+
-                                        +" is larger than maximum allowed error of "
-                                        +std::to_string(double(EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))));
+        this->startErrorReduction_(localError);
     }
 
     /*!
@@ -46,11 +46,13 @@
 #include <ewoms/io/vtkcompositionmodule.hh>
 #include <ewoms/io/vtkenergymodule.hh>
 #include <ewoms/io/vtkdiffusionmodule.hh>
+#include <ewoms/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -462,60 +464,66 @@ public:
     {
         numSwitched_ = 0;
 
-        int succeeded;
-        try {
-            std::vector<bool> visited(this->numGridDof(), false);
-            ElementContext elemCtx(this->simulator_);
+        // the DOFs are processed in parallel. since a DOF may be a primary DOF of
+        // several elements, each thread first claims the DOFs it processes.
+        std::vector<int> visited(this->numGridDof(), 0);
+        int succeeded = 1;
+        unsigned numSwitched = 0;
 
-            ElementIterator elemIt = this->gridView_.template begin<0>();
-            ElementIterator elemEndIt = this->gridView_.template end<0>();
-            for (; elemIt != elemEndIt; ++elemIt) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
-                elemCtx.updateStencil(elem);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            int threadSucceeded = 1;
+            unsigned threadNumSwitched = 0;
 
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+            try {
+                ElementContext elemCtx(this->simulator_);
 
-                    if (visited[globalIdx])
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
                         continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+                    elemCtx.updatePrimaryStencil(elem);
+
+                    size_t numLocalDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                        int numPreviousVisits;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+                        numPreviousVisits = visited[globalIdx]++;
+                        if (numPreviousVisits > 0)
+                            continue;
+
+                        if (switchPrimaryVarsOfDof_(elemCtx, dofIdx, globalIdx))
+                            ++threadNumSwitched;
                     }
                 }
             }
+            catch (...)
+            {
+                threadSucceeded = 0;
+            }
 
-            succeeded = 1;
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            {
+                numSwitched += threadNumSwitched;
+                succeeded = std::min(succeeded, threadSucceeded);
+            }
         }
-        catch (...)
-        {
+
+        if (!succeeded)
             std::cout << "rank " << this->simulator_.gridView().comm().rank()
                       << " caught an exception during primary variable switching"
                       << "\n"  << std::flush;
-            succeeded = 0;
-        }
+
         succeeded = this->simulator_.gridView().comm().min(succeeded);
 
         if (!succeeded)
@@ -524,13 +532,49 @@ public:
         // make sure that if there was a variable switch in an
         // other partition we will also set the switch flag
         // for our partition.
-        numSwitched_ = this->gridView_.comm().sum(numSwitched_);
+        numSwitched_ = this->gridView_.comm().sum(numSwitched);
 
         if (verbosity_ > 0)
             this->simulator_.model().newtonMethod().endIterMsg()
                 << ", num switched=" << numSwitched_;
     }
 
+    // evaluate the primary variable switch of a single degree of freedom. returns true
+    // if the phase presence of the degree of freedom has changed.
+    bool switchPrimaryVarsOfDof_(ElementContext& elemCtx, unsigned dofIdx, unsigned globalIdx)
+    {
+        auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+
+        // compute the intensive quantities of the current degree of freedom. the cache
+        // cannot be used here because the Newton method invalidates it after updating
+        // the solution.
+        elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+        // evaluate primary variable switch
+        short oldPhasePresence = priVars.phasePresence();
+
+        // set the primary variables and the new phase state
+        // from the current fluid state
+        priVars.assignNaive(intQuants.fluidState());
+
+        if (oldPhasePresence == priVars.phasePresence())
+            return false;
+
+        if (verbosity_ > 1) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            printSwitchedPhases_(elemCtx,
+                                 dofIdx,
+                                 intQuants.fluidState(),
+                                 oldPhasePresence,
+                                 priVars);
+        }
+
+        return true;
+    }
+
     template <class FluidState>
     void printSwitchedPhases_(const ElementContext& elemCtx,
                               unsigned dofIdx,
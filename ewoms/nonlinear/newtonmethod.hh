@@ -44,8 +44,16 @@
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <exception>
 #include <sstream>
+#include <vector>
 
 #include <unistd.h>
 
@@ -200,6 +208,11 @@ public:
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonRawTolerance);
 
         numIterations_ = 0;
+        initialError_ = 1e100;
+        solutionChange_ = -1.0;
+        lastIterateUsable_ = false;
+
+        errorReductionPending_ = false;
     }
 
     /*!
@@ -292,6 +305,26 @@ public:
     void setTolerance(Scalar value)
     { tolerance_ = value; }
 
+    /*!
+     * \brief Returns the maximum change of the solution between the beginning of the
+     *        time step and the most recent iterate.
+     *
+     * The exact measure of the change is model specific. A negative value indicates
+     * that the Newton method does not measure the change of the solution.
+     */
+    Scalar solutionChange() const
+    { return solutionChange_; }
+
+    /*!
+     * \brief Returns true if the Newton method failed during the last invocation but
+     *        still reduced the error.
+     *
+     * In this case, the last iterate is potentially a better initial guess for the
+     * retry than the solution of the last time step.
+     */
+    bool lastIterateUsable() const
+    { return lastIterateUsable_; }
+
     /*!
      * \brief Run the Newton method.
      *
@@ -323,6 +356,9 @@ public:
 
         Ewoms::TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
 
+        solutionChange_ = -1.0;
+        lastIterateUsable_ = false;
+
         // tell the implementation that we begin solving
         prePostProcessTimer_.start();
         asImp_().begin_(nextSolution);
@@ -369,6 +405,25 @@ public:
                 asImp_().preSolve_(currentSolution,  b);
                 updateTimer_.stop();
 
+                // if the error is still being reduced over all processes, set up the
+                // matrix of the linear solver in the meantime. this is wasted work if
+                // the Newton method turns out to be converged, but it hides the latency
+                // of the global reduction for all other iterations.
+                bool matrixPrepared = false;
+                if (errorReductionPending_) {
+                    solveTimer_.start();
+                    linearSolver_.prepareMatrix(M);
+                    solveTimer_.stop();
+                    matrixPrepared = true;
+                }
+
+                updateTimer_.start();
+                finishErrorReduction_();
+                checkMaxError_();
+                if (numIterations_ == 0)
+                    initialError_ = error_;
+                updateTimer_.stop();
+
                 if (!asImp_().proceed_()) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
@@ -391,7 +446,8 @@ public:
 
                 solveTimer_.start();
                 solutionUpdate = 0;
-                linearSolver_.prepareMatrix(M);
+                if (!matrixPrepared)
+                    linearSolver_.prepareMatrix(M);
                 bool converged = linearSolver_.solve(solutionUpdate);
                 solveTimer_.stop();
 
@@ -442,6 +498,7 @@ public:
                           << e.what() << "\"\n" << std::flush;
 
             prePostProcessTimer_.start();
+            finishErrorReduction_();
             asImp_().failed_();
             prePostProcessTimer_.stop();
 
@@ -454,6 +511,7 @@ public:
                           << e.what() << "\"\n" << std::flush;
 
             prePostProcessTimer_.start();
+            finishErrorReduction_();
             asImp_().failed_();
             prePostProcessTimer_.stop();
 
@@ -467,6 +525,7 @@ public:
 
         // tell the implementation that we're done
         prePostProcessTimer_.start();
+        finishErrorReduction_();
         asImp_().end_();
         prePostProcessTimer_.stop();
 
@@ -489,6 +548,8 @@ public:
 
         // if we're not converged, tell the implementation that we've failed
         if (!asImp_().converged()) {
+            lastIterateUsable_ = std::isfinite(error_) && error_ < initialError_;
+
             prePostProcessTimer_.start();
             asImp_().failed_();
             prePostProcessTimer_.stop();
@@ -572,7 +633,7 @@ protected:
      */
     bool verbose_() const
     {
-        return EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
+        return EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
     }
 
     /*!
@@ -585,7 +646,7 @@ protected:
     {
         numIterations_ = 0;
 
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
     }
 
@@ -604,37 +665,109 @@ protected:
     void linearize_()
     { model().linearizer().linearize(); }
 
+    /*!
+     * \brief Update the error of the solution after the linearization.
+     *
+     * This only starts the reduction of the error over all processes. The reduction is
+     * finished after the linear solver has set up its matrix.
+     *
+     * \param currentSolution The solution at the beginning the current iteration
+     * \param currentResidual The residual (i.e., right-hand-side) of the current
+     *                        iteration's solution.
+     */
     void preSolve_(const SolutionVector& currentSolution  OPM_UNUSED,
                    const GlobalEqVector& currentResidual)
     {
         const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
-        Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
-
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
+
+        // calculate the error as the maximum weighted tolerance of the solution's
+        // residual. auxiliary DOFs are not considered.
+        int numGridDof = static_cast<int>(model().numGridDof());
+        Scalar localError = 0.0;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadError = 0.0;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (int i = 0; i < numGridDof; ++i) {
+                unsigned dofIdx = static_cast<unsigned>(i);
+                if (model().dofTotalVolume(dofIdx) <= 0.0)
                     continue;
+
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_() && constraintsMap.count(dofIdx) > 0)
+                    continue;
+
+                const auto& r = currentResidual[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                    threadError = std::max(threadError,
+                                           std::abs(r[eqIdx]*model().eqWeight(dofIdx, eqIdx)));
             }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = Opm::max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            localError = std::max(localError, threadError);
         }
 
         // take the other processes into account
-        error_ = comm_.max(error_);
+        startErrorReduction_(localError);
+    }
 
-        // make sure that the error never grows beyond the maximum
-        // allowed one
+    /*!
+     * \brief Start to compute the maximum of a process-local error over all processes.
+     *
+     * If there is more than a single process, this uses a non-blocking collective
+     * operation and the result is written to error_ by finishErrorReduction_().
+     */
+    void startErrorReduction_(Scalar localError)
+    {
+        finishErrorReduction_();
+
+        error_ = localError;
+
+#if HAVE_MPI
+        if (comm_.size() > 1) {
+            errorReductionBuffer_[0] = static_cast<double>(localError);
+            MPI_Iallreduce(&errorReductionBuffer_[0],
+                           &errorReductionBuffer_[1],
+                           /*count=*/1,
+                           MPI_DOUBLE,
+                           MPI_MAX,
+                           static_cast<MPI_Comm>(comm_),
+                           &errorReductionRequest_);
+            errorReductionPending_ = true;
+        }
+#endif
+    }
+
+    /*!
+     * \brief Wait until a reduction started by startErrorReduction_() is complete.
+     *
+     * This method is a no-op if no reduction is in progress.
+     */
+    void finishErrorReduction_()
+    {
+        if (!errorReductionPending_)
+            return;
+
+#if HAVE_MPI
+        MPI_Wait(&errorReductionRequest_, MPI_STATUS_IGNORE);
+        error_ = static_cast<Scalar>(errorReductionBuffer_[1]);
+#endif
+        errorReductionPending_ = false;
+    }
+
+    /*!
+     * \brief Make sure that the error never grows beyond the maximum allowed one.
+     */
+    void checkMaxError_() const
+    {
+        Scalar newtonMaxError = EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonMaxError);
         if (error_ > newtonMaxError)
             throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(error_))
                                         +" is larger than maximum allowed error of "
@@ -685,19 +818,40 @@ protected:
         // analysis possible
         asImp_().writeConvergence_(currentSolution, solutionUpdate);
 
-        // make sure not to swallow non-finite values at this point
-        if (!std::isfinite(solutionUpdate.one_norm()))
-            throw Opm::NumericalIssue("Non-finite update!");
-
+        // mark the constraint DOFs, so that the map of constraints does not need to be
+        // searched for every DOF
         size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
+        std::vector<unsigned char> isConstraintDof;
+        if (enableConstraints_()) {
+            isConstraintDof.resize(numGridDof, 0);
+            for (const auto& constraintsPair : constraintsMap)
+                isConstraintDof[constraintsPair.first] = 1;
+        }
+
+        // the DOFs are updated in parallel. this requires the updatePrimaryVariables_()
+        // method of the implementation to be thread-safe for distinct DOFs. since
+        // exceptions must not leave the parallel region, they are re-thrown
+        // afterwards.
+        int numGridDofInt = static_cast<int>(numGridDof);
+        int updateIsFinite = 1;
+        std::exception_ptr exception;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min: updateIsFinite)
+#endif
+        for (int dofIdxInt = 0; dofIdxInt < numGridDofInt; ++dofIdxInt) {
+            unsigned dofIdx = static_cast<unsigned>(dofIdxInt);
+
+            // make sure not to swallow non-finite values at this point
+            const auto& dofUpdate = solutionUpdate[dofIdx];
+            for (unsigned eqIdx = 0; eqIdx < dofUpdate.size(); ++eqIdx)
+                if (!std::isfinite(dofUpdate[eqIdx]))
+                    updateIsFinite = 0;
+
+            try {
+                if (enableConstraints_() && isConstraintDof[dofIdx])
                     asImp_().updateConstraintDof_(dofIdx,
                                                   nextSolution[dofIdx],
-                                                  constraints);
-                }
+                                                  constraintsMap.at(dofIdx));
                 else
                     asImp_().updatePrimaryVariables_(dofIdx,
                                                      nextSolution[dofIdx],
@@ -705,20 +859,34 @@ protected:
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+            }
         }
 
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
+            const auto& dofUpdate = solutionUpdate[dofIdx];
+            for (unsigned eqIdx = 0; eqIdx < dofUpdate.size(); ++eqIdx)
+                if (!std::isfinite(dofUpdate[eqIdx]))
+                    updateIsFinite = 0;
+
             nextSolution[dofIdx] = currentSolution[dofIdx];
-            nextSolution[dofIdx] -= solutionUpdate[dofIdx];
+            nextSolution[dofIdx] -= dofUpdate;
         }
+
+        if (!updateIsFinite)
+            throw Opm::NumericalIssue("Non-finite update!");
+
+        if (exception)
+            std::rethrow_exception(exception);
     }
 
     /*!
@@ -751,7 +919,7 @@ protected:
     void writeConvergence_(const SolutionVector& currentSolution,
                            const GlobalEqVector& solutionUpdate)
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
             convergenceWriter_.beginIteration();
             convergenceWriter_.writeFields(currentSolution, solutionUpdate);
             convergenceWriter_.endIteration();
@@ -808,7 +976,7 @@ protected:
      */
     void end_()
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.endTimeStep();
     }
 
@@ -830,10 +998,10 @@ protected:
 
     // optimal number of iterations we want to achieve
     int targetIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonTargetIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonTargetIterations); }
     // maximum number of iterations we do before giving up
     int maxIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonMaxIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonMaxIterations); }
 
     static bool enableConstraints_()
     { return GET_PROP_VALUE(TypeTag, EnableConstraints); }
@@ -849,8 +1017,15 @@ protected:
 
     Scalar error_;
     Scalar lastError_;
+    Scalar initialError_;
     Scalar tolerance_;
 
+    // the change of the solution within the time step. this needs to be set by the
+    // model specific Newton methods
+    Scalar solutionChange_;
+
+    bool lastIterateUsable_;
+
     // actual number of iterations done so far
     int numIterations_;
 
@@ -865,6 +1040,13 @@ protected:
     // method to disk
     ConvergenceWriter convergenceWriter_;
 
+    // state of the non-blocking reduction of the error over all processes
+    bool errorReductionPending_;
+#if HAVE_MPI
+    MPI_Request errorReductionRequest_;
+    double errorReductionBuffer_[2];
+#endif
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -0,0 +1,180 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Ewoms::EntityChunks
+ */
+#ifndef EWOMS_ENTITY_CHUNKS_HH
+#define EWOMS_ENTITY_CHUNKS_HH
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cassert>
+
+namespace Ewoms {
+
+/*!
+ * \brief Partitions the entities of a GridView into chunks of consecutive entities and
+ *        assigns a contiguous range of these chunks to each thread.
+ *
+ * Creating the partition requires a full sequential traversal of the grid view, so
+ * objects of this class are supposed to be created once and only be updated if the grid
+ * has changed. Iterating over the entities using the partition is then done using
+ * Ewoms::ThreadedEntityIterator.
+ */
+template <class GridView, int codim>
+class EntityChunks
+{
+public:
+    typedef typename GridView::template Codim<codim>::Iterator EntityIterator;
+
+    /*!
+     * \brief A range of consecutive entities of the grid view.
+     */
+    struct Chunk
+    {
+        EntityIterator begin;
+        unsigned size;
+    };
+
+    EntityChunks()
+        : sequenceNumber_(-1)
+        , numEntities_(0)
+        , enableWorkStealing_(true)
+    { }
+
+    /*!
+     * \brief (Re-)create the partition of the entities of a grid view.
+     *
+     * \param gridView The grid view to be partitioned
+     * \param numThreads The number of threads which ought to work on the grid view
+     * \param sequenceNumber The sequence number of the grid to be partitioned
+     * \param chunksPerThread The targeted number of chunks assigned to each thread. More
+     *                        chunks allow for a better load balancing if work stealing
+     *                        is enabled.
+     */
+    void update(const GridView& gridView,
+                unsigned numThreads,
+                int sequenceNumber,
+                unsigned chunksPerThread = 16)
+    {
+        assert(numThreads > 0);
+
+        gridView_.reset(new GridView(gridView));
+        sequenceNumber_ = sequenceNumber;
+        chunks_.clear();
+
+        numEntities_ = static_cast<size_t>(gridView.size(codim));
+        size_t chunkSize =
+            std::max<size_t>(1, (numEntities_ + numThreads*chunksPerThread - 1)/(numThreads*chunksPerThread));
+
+        EntityIterator it = gridView.template begin<codim>();
+        const EntityIterator endIt = gridView.template end<codim>();
+        while (it != endIt) {
+            Chunk chunk = { it, /*size=*/0 };
+            for (; it != endIt && chunk.size < chunkSize; ++it)
+                ++ chunk.size;
+            chunks_.push_back(chunk);
+        }
+
+        // distribute the chunks evenly amongst the threads
+        threadChunksBegin_.resize(numThreads + 1);
+        for (unsigned threadId = 0; threadId <= numThreads; ++threadId)
+            threadChunksBegin_[threadId] = (chunks_.size()*threadId)/numThreads;
+    }
+
+    /*!
+     * \brief Returns true iff the partition has been created for a grid with a given
+     *        sequence number.
+     */
+    bool isUpToDate(int sequenceNumber) const
+    { return gridView_ && sequenceNumber_ == sequenceNumber; }
+
+    /*!
+     * \brief Specify whether threads which have finished their own range of chunks may
+     *        take over chunks which are assigned to other threads.
+     */
+    void setEnableWorkStealing(bool yesno)
+    { enableWorkStealing_ = yesno; }
+
+    /*!
+     * \brief Returns true iff threads may work on the chunks assigned to other threads.
+     */
+    bool enableWorkStealing() const
+    { return enableWorkStealing_; }
+
+    /*!
+     * \brief The grid view which has been partitioned.
+     */
+    const GridView& gridView() const
+    { return *gridView_; }
+
+    /*!
+     * \brief The number of threads for which the partition has been created.
+     */
+    unsigned numThreads() const
+    { return static_cast<unsigned>(threadChunksBegin_.size() - 1); }
+
+    /*!
+     * \brief The total number of entities of the partitioned grid view.
+     */
+    size_t numEntities() const
+    { return numEntities_; }
+
+    /*!
+     * \brief The total number of chunks.
+     */
+    size_t numChunks() const
+    { return chunks_.size(); }
+
+    /*!
+     * \brief Returns a chunk given its index.
+     */
+    const Chunk& chunk(size_t chunkIdx) const
+    { return chunks_[chunkIdx]; }
+
+    /*!
+     * \brief The index of the first chunk which is assigned to a thread.
+     */
+    size_t threadChunksBegin(unsigned threadId) const
+    { return threadChunksBegin_[threadId]; }
+
+    /*!
+     * \brief The index after the last chunk which is assigned to a thread.
+     */
+    size_t threadChunksEnd(unsigned threadId) const
+    { return threadChunksBegin_[threadId + 1]; }
+
+private:
+    std::unique_ptr<GridView> gridView_;
+    int sequenceNumber_;
+    size_t numEntities_;
+    bool enableWorkStealing_;
+
+    std::vector<Chunk> chunks_;
+    std::vector<size_t> threadChunksBegin_;
+};
+} // namespace Ewoms
+
+#endif
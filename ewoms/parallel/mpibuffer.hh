@@ -122,18 +122,37 @@ public:
 #endif // HAVE_MPI
     }
 
+    /*!
+     * \brief Start to receive the buffer asyncronously from a peer rank
+     *
+     * The data is only valid after wait() returned or after the request of the buffer
+     * has been completed by other means.
+     */
+    void receiveAsync(unsigned peerRank)
+    {
+#if HAVE_MPI
+        MPI_Irecv(data_,
+                  static_cast<int>(mpiDataSize_),
+                  mpiDataType_,
+                  static_cast<int>(peerRank),
+                  0, // tag
+                  MPI_COMM_WORLD,
+                  &mpiRequest_);
+#endif // HAVE_MPI
+    }
+
 #if HAVE_MPI
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and receiveAsync() methods.
      */
     MPI_Request& request()
     { return mpiRequest_; }
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and receiveAsync() methods.
      */
     const MPI_Request& request() const
     { return mpiRequest_; }
@@ -30,9 +30,15 @@
 #include <stdexcept>
 #include <cassert>
 #include <thread>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
+#include <future>
+#include <exception>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 namespace Ewoms {
 
@@ -49,7 +55,6 @@ public:
     {}
     virtual ~TaskletInterface() {}
     virtual void run() = 0;
-    virtual bool isEndMarker () const { return false; }
 
     void dereference()
     { -- referenceCount_; }
@@ -62,63 +67,57 @@ private:
 };
 
 /*!
- * \brief Handles where a given tasklet is run.
- *
- * Depending on the number of worker threads, a tasklet can either be run in a separate
- * worker thread or by the main thread.
+ * \brief Statistics about the tasklets which have been completed by a tasklet runner.
  */
-class TaskletRunner
+struct TaskletStatistics
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
-    {
-    public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
-        {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
-        }
+    TaskletStatistics()
+        : numCompleted(0)
+        , totalRunTime(0.0)
+        , maxRunTime(0.0)
+        , totalQueueTime(0.0)
+        , totalDispatchWaitTime(0.0)
+    {}
 
-        void run()
-        { wait(); }
+    //! The number of tasklets which have been completed
+    size_t numCompleted;
 
-        void wait()
-        {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
+    //! The accumulated time spend running the tasklets [s]
+    double totalRunTime;
 
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
-            }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
+    //! The time which was required by the longest running tasklet [s]
+    double maxRunTime;
 
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
-            }
-        }
+    //! The accumulated time which the tasklets spend in the queue before they were run [s]
+    double totalQueueTime;
 
-    private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
+    //! The accumulated time which dispatching threads had to wait for space in the queue [s]
+    double totalDispatchWaitTime;
+};
 
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
-    };
+/*!
+ * \brief Handles where a given tasklet is run.
+ *
+ * Depending on the number of worker threads, a tasklet can either be run in a separate
+ * worker thread or by the main thread. In the asynchronous case, the tasklets are
+ * stored in a work queue which optionally has a limited capacity: If the queue is full,
+ * dispatch() blocks until one of the dispatched tasklets has been completed.
+ * This keeps the amount of memory which is occupied by the data of the pending tasklets
+ * bounded.
+ */
+class TaskletRunner
+{
+    typedef std::chrono::steady_clock Clock;
 
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
+    // a tasklet in the work queue
+    struct Job_
     {
-    public:
-        void run()
-        { }
-
-        bool isEndMarker() const
-        { return true; }
+        std::shared_ptr<TaskletInterface> tasklet;
+        std::promise<void> completed;
+        std::exception_ptr exception;
+        Clock::time_point dispatchTime;
+        double runTime;
+        int numUnfinishedRuns;
     };
 
 public:
@@ -129,13 +128,14 @@ public:
      * \brief Creates a tasklet runner with numWorkers underling threads for doing work.
      *
      * The number of worker threads may be 0. In this case, all work is done by the main
-     * thread (synchronous mode).
+     * thread (synchronous mode). If maxQueueSize is larger than 0, at most this number
+     * of tasklets are queued or being run by a worker thread at any time.
      */
-    TaskletRunner(unsigned numWorkers)
+    TaskletRunner(unsigned numWorkers, unsigned maxQueueSize = 0)
+        : maxQueueSize_(maxQueueSize)
+        , numPending_(0)
+        , terminate_(false)
     {
-        // make sure that the worker threads block when the tasklet queue is empty
-        runnerMutex_.lock();
-
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -152,8 +152,11 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            {
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                terminate_ = true;
+            }
+            workAvailable_.notify_all();
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -161,49 +164,126 @@ public:
         }
     }
 
+    /*!
+     * \brief Returns the number of worker threads of the tasklet runner.
+     */
+    unsigned numWorkerThreads() const
+    { return static_cast<unsigned>(threads_.size()); }
+
+    /*!
+     * \brief Returns the maximum number of queued or running tasklets. 0 means
+     *        unlimited.
+     */
+    unsigned maxQueueSize() const
+    { return maxQueueSize_; }
+
     /*!
      * \brief Add a new tasklet.
      *
-     * The tasklet is either run immediately or deferred to a separate thread.
+     * The tasklet is either run immediately or deferred to a separate thread. The
+     * returned future becomes ready as soon as the tasklet has been completed. If the
+     * tasklet threw an exception, it is stored in the future.
      */
-    void dispatch(std::shared_ptr<TaskletInterface> tasklet)
+    std::shared_future<void> dispatch(std::shared_ptr<TaskletInterface> tasklet)
     {
         if (threads_.empty()) {
             // run the tasklet immediately in synchronous mode.
-            while (tasklet->referenceCount() > 0) {
-                tasklet->dereference();
-                tasklet->run();
+            std::exception_ptr exception;
+            auto startTime = Clock::now();
+            try {
+                while (tasklet->referenceCount() > 0) {
+                    tasklet->dereference();
+                    tasklet->run();
+                }
             }
+            catch (...) {
+                exception = std::current_exception();
+            }
+            double runTime = secondsSince_(startTime);
+
+            std::promise<void> completed;
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            recordCompletion_(runTime, /*queueTime=*/0.0);
+            if (exception) {
+                if (!firstException_)
+                    firstException_ = exception;
+                completed.set_exception(exception);
+            }
+            else
+                completed.set_value();
+
+            return completed.get_future().share();
         }
-        else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
 
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
-            // fire up a worker thread
-            runnerMutex_.unlock();
+        std::shared_ptr<Job_> job = std::make_shared<Job_>();
+        job->tasklet = tasklet;
+        job->runTime = 0.0;
+        job->numUnfinishedRuns = tasklet->referenceCount();
+        std::shared_future<void> future = job->completed.get_future().share();
 
-            taskletQueueMutex_.unlock();
+        {
+            // wait until there is space in the queue. tasklets which are currently
+            // being run count against the limit because they still hold their data.
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            auto waitStartTime = Clock::now();
+            spaceAvailable_.wait(lock,
+                                 [this]() -> bool
+                                 { return this->maxQueueSize_ == 0 || this->numPending_ < this->maxQueueSize_; });
+            statistics_.totalDispatchWaitTime += secondsSince_(waitStartTime);
+
+            job->dispatchTime = Clock::now();
+            queue_.push_back(job);
+            ++ numPending_;
         }
+
+        // a tasklet which needs to be run multiple times may keep several workers busy
+        if (job->numUnfinishedRuns > 1)
+            workAvailable_.notify_all();
+        else
+            workAvailable_.notify_one();
+
+        return future;
     }
 
     /*!
      * \brief Make sure that all tasklets have been completed after this method has been called
+     *
+     * If any of the tasklets which were completed since the last barrier threw an
+     * exception, the first of these exceptions is re-thrown.
      */
     void barrier()
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
-            // nothing needs to be done to implement a barrier in synchronous mode
-            return;
+        std::exception_ptr exception;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            allDone_.wait(lock,
+                          [this]() -> bool
+                          { return this->numPending_ == 0; });
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
+            std::swap(exception, firstException_);
+        }
 
-        barrierTasklet->wait();
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    /*!
+     * \brief Returns the number of tasklets which have been dispatched but which are not
+     *        yet completed.
+     */
+    size_t numPending() const
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        return numPending_;
+    }
+
+    /*!
+     * \brief Returns the statistics about the completed tasklets.
+     */
+    TaskletStatistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        return statistics_;
     }
 
 protected:
@@ -211,55 +291,92 @@ protected:
     static void startWorkerThread_(TaskletRunner* taskletRunner)
     { taskletRunner->run_(); }
 
-    //! do the work until the queue received an end tasklet
+    //! do the work until the runner is destroyed and all tasklets have been processed
     void run_()
     {
+        std::unique_lock<std::mutex> lock(queueMutex_);
         while (true) {
             // wait until tasklets have been pushed to the queue.
-            //
-            // The unlocking is done in the thread that adds a task
-            runnerMutex_.lock();
-
-            // lock mutex for access to taskletQueue_
-            taskletQueueMutex_.lock();
-
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
-
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                runnerMutex_.unlock();
+            workAvailable_.wait(lock,
+                                [this]() -> bool
+                                { return this->terminate_ || !this->queue_.empty(); });
+
+            if (queue_.empty()) {
+                assert(terminate_);
                 return;
             }
 
-            tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-
-            // if the queue is not yet empty, make sure that we the next tasklet
-            // can be processed immediately.
-            if (!taskletQueue_.empty())
-                runnerMutex_.unlock();
-
-            // unlock mutex for access to taskletQueue_
-            taskletQueueMutex_.unlock();
+            std::shared_ptr<Job_> job = queue_.front();
+            double queueTime = secondsSince_(job->dispatchTime);
+
+            // remove tasklets from the queue as soon as their reference count reaches
+            // zero, i.e. the tasklet has been run often enough.
+            job->tasklet->dereference();
+            if (job->tasklet->referenceCount() == 0)
+                queue_.pop_front();
+
+            // execute tasklet without holding the lock
+            lock.unlock();
+            std::exception_ptr exception;
+            auto startTime = Clock::now();
+            try {
+                job->tasklet->run();
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+            double runTime = secondsSince_(startTime);
+            lock.lock();
+
+            job->runTime += runTime;
+            if (exception && !job->exception)
+                job->exception = exception;
+
+            if (-- job->numUnfinishedRuns > 0)
+                continue;
+
+            // the tasklet is completed
+            recordCompletion_(job->runTime, queueTime);
+            if (job->exception) {
+                if (!firstException_)
+                    firstException_ = job->exception;
+                job->completed.set_exception(job->exception);
+            }
+            else
+                job->completed.set_value();
 
-            // execute tasklet
-            tasklet->run();
+            -- numPending_;
+            spaceAvailable_.notify_one();
+            if (numPending_ == 0)
+                allDone_.notify_all();
         }
     }
 
+    // update the statistics for a completed tasklet. queueMutex_ must be locked.
+    void recordCompletion_(double runTime, double queueTime)
+    {
+        ++ statistics_.numCompleted;
+        statistics_.totalRunTime += runTime;
+        statistics_.maxRunTime = std::max(statistics_.maxRunTime, runTime);
+        statistics_.totalQueueTime += queueTime;
+    }
+
+    static double secondsSince_(const Clock::time_point& t)
+    { return std::chrono::duration<double>(Clock::now() - t).count(); }
+
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
-    std::mutex runnerMutex_;
+    std::deque<std::shared_ptr<Job_> > queue_;
+    unsigned maxQueueSize_;
+    size_t numPending_;
+    bool terminate_;
+    std::exception_ptr firstException_;
+    TaskletStatistics statistics_;
+
+    mutable std::mutex queueMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable spaceAvailable_;
+    std::condition_variable allDone_;
 };
 
-} // end namespace Opm
+} // end namespace Ewoms
 #endif
@@ -28,6 +28,17 @@
 #define EWOMS_THREADED_ENTITY_ITERATOR_HH
 
 #include <ewoms/parallel/locks.hh>
+#include <ewoms/parallel/entitychunks.hh>
+#include <ewoms/common/alignedallocator.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace Ewoms {
 
@@ -35,6 +46,13 @@ namespace Ewoms {
  * \brief Provides an STL-iterator like interface to iterate over the enties of a
  *        GridView in OpenMP threaded applications
  *
+ * If the iterator is constructed from a Ewoms::EntityChunks object, each thread first
+ * works on the range of chunks which has been assigned to it by the partition. Threads
+ * which have finished their own range may then optionally "steal" chunks from the
+ * ranges of the other threads. Handing out entities thus only requires an atomic
+ * operation per chunk. If the iterator is constructed from a grid view, every entity is
+ * handed out individually under the protection of a mutex.
+ *
  * ATTENTION: This class must be instantiated in a sequential context!
  */
 template <class GridView, int codim>
@@ -42,18 +60,58 @@ class ThreadedEntityIterator
 {
     typedef typename GridView::template Codim<codim>::Entity Entity;
     typedef typename GridView::template Codim<codim>::Iterator EntityIterator;
+    typedef Ewoms::EntityChunks<GridView, codim> EntityChunks;
+
+    // the state of the iteration of an individual thread. the objects are aligned to
+    // cache lines to avoid false sharing between threads.
+    struct alignas(64) ThreadState
+    {
+        EntityIterator it;
+        unsigned remaining;
+    };
+
+    typedef std::vector<ThreadState, Ewoms::aligned_allocator<ThreadState, 64> > ThreadStateVector;
+
 public:
     ThreadedEntityIterator(const GridView& gridView)
         : gridView_(gridView)
         , sequentialIt_(gridView_.template begin<codim>())
         , sequentialEnd_(gridView.template end<codim>())
+        , chunks_(nullptr)
+        , enableWorkStealing_(false)
     { }
 
-    ThreadedEntityIterator(const ThreadedEntityIterator& other) = default;
+    ThreadedEntityIterator(const EntityChunks& chunks)
+        : gridView_(chunks.gridView())
+        , sequentialIt_(gridView_.template end<codim>())
+        , sequentialEnd_(gridView_.template end<codim>())
+        , chunks_(&chunks)
+        , enableWorkStealing_(chunks.enableWorkStealing())
+        , threadState_(maxThreads_(chunks), ThreadState{sequentialEnd_, /*remaining=*/0})
+        , nextChunkIdx_(new std::atomic<size_t>[chunks.numThreads()])
+    {
+        for (unsigned threadId = 0; threadId < chunks.numThreads(); ++threadId)
+            nextChunkIdx_[threadId] = chunks.threadChunksBegin(threadId);
+    }
+
+    ThreadedEntityIterator(const ThreadedEntityIterator& other) = delete;
 
     // begin iterating over the grid in parallel
     EntityIterator beginParallel()
     {
+        if (chunks_) {
+            unsigned threadId = threadId_();
+            if (threadId >= threadState_.size())
+                // the parallel region uses more threads than omp_get_max_threads()
+                // reported when the iterator was created. such threads do not get any
+                // work, the chunks are taken over by the remaining threads.
+                return sequentialEnd_;
+
+            ThreadState& state = threadState_[threadId];
+            state.remaining = 0;
+            return increment();
+        }
+
         mutex_.lock();
         auto tmp = sequentialIt_;
         if (sequentialIt_ != sequentialEnd_)
@@ -71,6 +129,23 @@ public:
     // thread
     EntityIterator increment()
     {
+        if (chunks_) {
+            unsigned threadId = threadId_();
+            if (threadId >= threadState_.size())
+                return sequentialEnd_;
+
+            ThreadState& state = threadState_[threadId];
+            if (state.remaining > 0) {
+                ++state.it;
+                -- state.remaining;
+                return state.it;
+            }
+
+            if (!claimChunk_(state))
+                state.it = sequentialEnd_;
+            return state.it;
+        }
+
         mutex_.lock();
         auto tmp = sequentialIt_;
         if (sequentialIt_ != sequentialEnd_)
@@ -81,11 +156,71 @@ public:
     }
 
 private:
+    // the number of threads for which a state must be allocated. the team of the next
+    // parallel region may be larger than the number of threads of the partition.
+    static size_t maxThreads_(const EntityChunks& chunks)
+    {
+#ifdef _OPENMP
+        return std::max<size_t>(chunks.numThreads(), static_cast<size_t>(omp_get_max_threads()));
+#else
+        return chunks.numThreads();
+#endif
+    }
+
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    // grab the next chunk which has not been worked on yet. returns false if there is
+    // no such chunk.
+    bool claimChunk_(ThreadState& state)
+    {
+        unsigned numRanges = chunks_->numThreads();
+        unsigned threadId = threadId_();
+
+        // if the current parallel region uses a different number of threads than the
+        // partition, some ranges would never be visited without work stealing
+        bool steal = enableWorkStealing_;
+#ifdef _OPENMP
+        steal = steal || static_cast<unsigned>(omp_get_num_threads()) != numRanges;
+#endif
+
+        for (unsigned i = 0; i < numRanges; ++i) {
+            if (i > 0 && !steal)
+                break;
+
+            unsigned rangeIdx = (threadId + i) % numRanges;
+            if (nextChunkIdx_[rangeIdx].load(std::memory_order_relaxed) >= chunks_->threadChunksEnd(rangeIdx))
+                continue; // range is already exhausted
+
+            size_t chunkIdx = nextChunkIdx_[rangeIdx].fetch_add(1, std::memory_order_relaxed);
+            if (chunkIdx >= chunks_->threadChunksEnd(rangeIdx))
+                continue; // some other thread was faster
+
+            const auto& chunk = chunks_->chunk(chunkIdx);
+            state.it = chunk.begin;
+            state.remaining = chunk.size - 1;
+            return true;
+        }
+
+        return false;
+    }
+
     GridView gridView_;
     EntityIterator sequentialIt_;
     EntityIterator sequentialEnd_;
 
     OmpMutex mutex_;
+
+    const EntityChunks* chunks_;
+    bool enableWorkStealing_;
+    ThreadStateVector threadState_;
+    std::unique_ptr<std::atomic<size_t>[]> nextChunkIdx_;
 };
 } // namespace Ewoms
 
@@ -0,0 +1,117 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This file tests the parameters which cache their values.
+ */
+#include "config.h"
+
+#include <ewoms/common/parametersystem.hh>
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+namespace Ewoms {
+namespace Properties {
+NEW_TYPE_TAG(CachedParamTest, INHERITS_FROM(ParameterSystem));
+
+NEW_PROP_TAG(Scalar);
+NEW_PROP_TAG(SomeInt);
+NEW_PROP_TAG(SomeScalar);
+
+SET_TYPE_PROP(CachedParamTest, Scalar, double);
+SET_INT_PROP(CachedParamTest, SomeInt, 3);
+SET_SCALAR_PROP(CachedParamTest, SomeScalar, 1.5);
+}}
+
+typedef TTAG(CachedParamTest) TypeTag;
+typedef GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+
+int main()
+{
+    EWOMS_REGISTER_PARAM(TypeTag, int, SomeInt, "An integer parameter");
+    EWOMS_REGISTER_PARAM(TypeTag, double, SomeScalar, "A floating point parameter");
+
+    // cached parameters cannot be retrieved before the registration is closed. this
+    // must not prevent them from being retrieved afterwards.
+    bool caught = false;
+    try {
+        EWOMS_GET_CACHED_PARAM(TypeTag, int, SomeInt);
+    }
+    catch (const std::runtime_error&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+
+    const char* argv[] = { "test_cachedparams", "--some-int=5" };
+    std::string errorMsg =
+        Ewoms::Parameters::parseCommandLineOptions<TypeTag>(/*argc=*/2, argv, /*handleHelp=*/false);
+    REQUIRE(errorMsg.empty());
+    EWOMS_END_PARAM_REGISTRATION(TypeTag);
+
+    // the cached values are the same as the ones which are retrieved directly. for
+    // parameters which are not specified, the value of the property is used.
+    REQUIRE(EWOMS_GET_CACHED_PARAM(TypeTag, int, SomeInt) == 5);
+    REQUIRE(EWOMS_GET_PARAM(TypeTag, int, SomeInt) == 5);
+    REQUIRE(EWOMS_GET_CACHED_PARAM(TypeTag, double, SomeScalar) == 1.5);
+
+    // modifying the parameter tree does not affect the cached values until they are
+    // invalidated
+    ParamsMeta::tree()["SomeInt"] = "7";
+    ParamsMeta::tree()["SomeScalar"] = "2.5";
+    REQUIRE(EWOMS_GET_PARAM(TypeTag, int, SomeInt) == 7);
+    REQUIRE(EWOMS_GET_CACHED_PARAM(TypeTag, int, SomeInt) == 5);
+    REQUIRE(EWOMS_GET_CACHED_PARAM(TypeTag, double, SomeScalar) == 1.5);
+
+    Ewoms::Parameters::invalidateCachedParams();
+
+    // after the invalidation, the values are retrieved again. this may happen
+    // concurrently.
+    const int numIterations = 1000;
+    std::vector<int> intValues(numIterations);
+    std::vector<double> scalarValues(numIterations);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < numIterations; ++i) {
+        intValues[i] = EWOMS_GET_CACHED_PARAM(TypeTag, int, SomeInt);
+        scalarValues[i] = EWOMS_GET_CACHED_PARAM(TypeTag, double, SomeScalar);
+    }
+
+    for (int i = 0; i < numIterations; ++i) {
+        REQUIRE(intValues[i] == 7);
+        REQUIRE(scalarValues[i] == 2.5);
+    }
+
+    std::cout << "Cached parameter tests passed\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test which makes sure that the linearization which assembles colored element
+ *        chunks without locking yields the same system of equations as the one which
+ *        protects the global matrix by a lock.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <ewoms/common/start.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+namespace Ewoms {
+namespace Properties {
+NEW_TYPE_TAG(LensColoredLinearizationTest, INHERITS_FROM(LensProblemEcfvAd));
+NEW_TYPE_TAG(LensLockedLinearizationTest, INHERITS_FROM(LensProblemEcfvAd));
+
+// use a small grid
+SET_INT_PROP(LensColoredLinearizationTest, CellsX, 24);
+SET_INT_PROP(LensColoredLinearizationTest, CellsY, 16);
+SET_INT_PROP(LensLockedLinearizationTest, CellsX, 24);
+SET_INT_PROP(LensLockedLinearizationTest, CellsY, 16);
+
+SET_BOOL_PROP(LensColoredLinearizationTest, EnableColoredLinearization, true);
+SET_BOOL_PROP(LensLockedLinearizationTest, EnableColoredLinearization, false);
+}}
+
+template <class TypeTag>
+std::unique_ptr<typename GET_PROP_TYPE(TypeTag, Simulator)>
+initSimulator()
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+
+    // the coloring is only used if more than a single thread is available
+    std::vector<const char*> argv = { "test_coloredlinearization" };
+#ifdef _OPENMP
+    argv.push_back("--threads-per-process=4");
+#endif
+    int status = Ewoms::setupParameters_<TypeTag>(static_cast<int>(argv.size()), argv.data());
+    REQUIRE(status == 0);
+    ThreadManager::init();
+
+    // the simulator uses the initial time step size for the linearization
+    std::unique_ptr<Simulator> simulator(new Simulator(/*verbose=*/false));
+    simulator->model().applyInitialSolution();
+    return simulator;
+}
+
+// returns the maximum absolute value of an entry of two block vectors and the maximum
+// difference between them
+template <class BlockVector>
+void compareVectors(const BlockVector& a, const BlockVector& b, double& maxAbs, double& maxDiff)
+{
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (unsigned j = 0; j < a[i].size(); ++j) {
+            maxAbs = std::max(maxAbs, std::max(std::abs(double(a[i][j])), std::abs(double(b[i][j]))));
+            maxDiff = std::max(maxDiff, std::abs(double(a[i][j] - b[i][j])));
+        }
+    }
+}
+
+template <class Matrix>
+void compareMatrices(const Matrix& a, const Matrix& b, double& maxAbs, double& maxDiff)
+{
+    REQUIRE(a.N() == b.N());
+    REQUIRE(a.M() == b.M());
+    REQUIRE(a.nonzeroes() == b.nonzeroes());
+
+    for (auto rowIt = a.begin(); rowIt != a.end(); ++rowIt) {
+        const auto& rowB = b[rowIt.index()];
+        auto colItB = rowB.begin();
+        for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt, ++colItB) {
+            REQUIRE(colItB != rowB.end());
+            REQUIRE(colIt.index() == colItB.index());
+            compareVectors(*colIt, *colItB, maxAbs, maxDiff);
+        }
+        REQUIRE(colItB == rowB.end());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    typedef TTAG(LensColoredLinearizationTest) ColoredTypeTag;
+    typedef TTAG(LensLockedLinearizationTest) LockedTypeTag;
+
+    // the two type tags only differ by the default value of the parameter which
+    // enables the coloring
+    auto coloredSimulator = initSimulator<ColoredTypeTag>();
+    auto lockedSimulator = initSimulator<LockedTypeTag>();
+
+    auto& coloredLinearizer = coloredSimulator->model().linearizer();
+    auto& lockedLinearizer = lockedSimulator->model().linearizer();
+
+    // linearize twice, so that the second linearization works on a matrix which
+    // already contains values
+    for (int i = 0; i < 2; ++i) {
+        coloredLinearizer.linearize();
+        lockedLinearizer.linearize();
+
+        // the contributions of the elements are added in a different order, so the
+        // results are only equal up to round-off errors
+        double maxAbs = 0.0;
+        double maxDiff = 0.0;
+        compareVectors(coloredLinearizer.residual(), lockedLinearizer.residual(), maxAbs, maxDiff);
+        REQUIRE(maxAbs > 0.0);
+        REQUIRE(maxDiff <= 1e-10*maxAbs);
+
+        maxAbs = 0.0;
+        maxDiff = 0.0;
+        compareMatrices(coloredLinearizer.matrix(), lockedLinearizer.matrix(), maxAbs, maxDiff);
+        REQUIRE(maxAbs > 0.0);
+        REQUIRE(maxDiff <= 1e-10*maxAbs);
+    }
+
+    std::cout << "Colored and locked linearization yield the same results\n";
+    return 0;
+}
@@ -0,0 +1,148 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the partition of the elements into chunks and the threaded
+ *        iteration over them.
+ */
+#include "config.h"
+
+#include <ewoms/parallel/entitychunks.hh>
+#include <ewoms/parallel/threadedentityiterator.hh>
+
+#include <dune/grid/yaspgrid.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+const unsigned dim = 2;
+typedef Dune::YaspGrid<dim> Grid;
+typedef Grid::LeafGridView GridView;
+typedef Ewoms::EntityChunks<GridView, /*codim=*/0> ElementChunks;
+
+void testPartition(const GridView& gridView)
+{
+    const unsigned numThreads = 3;
+    ElementChunks chunks;
+    REQUIRE(!chunks.isUpToDate(/*sequenceNumber=*/0));
+    chunks.update(gridView, numThreads, /*sequenceNumber=*/0, /*chunksPerThread=*/4);
+    REQUIRE(chunks.isUpToDate(0));
+    REQUIRE(!chunks.isUpToDate(1));
+    REQUIRE(chunks.numThreads() == numThreads);
+    REQUIRE(chunks.numEntities() == static_cast<size_t>(gridView.size(0)));
+
+    // the ranges of the threads are contiguous and cover all chunks
+    REQUIRE(chunks.threadChunksBegin(0) == 0);
+    for (unsigned threadId = 0; threadId + 1 < numThreads; ++threadId)
+        REQUIRE(chunks.threadChunksEnd(threadId) == chunks.threadChunksBegin(threadId + 1));
+    REQUIRE(chunks.threadChunksEnd(numThreads - 1) == chunks.numChunks());
+
+    // the chunks consist of consecutive elements and cover the grid view in order
+    auto elemIt = gridView.begin<0>();
+    size_t numElements = 0;
+    for (size_t chunkIdx = 0; chunkIdx < chunks.numChunks(); ++chunkIdx) {
+        const auto& chunk = chunks.chunk(chunkIdx);
+        REQUIRE(chunk.size > 0);
+        REQUIRE(chunk.begin == elemIt);
+        for (unsigned i = 0; i < chunk.size; ++i)
+            ++ elemIt;
+        numElements += chunk.size;
+    }
+    REQUIRE(elemIt == gridView.end<0>());
+    REQUIRE(numElements == chunks.numEntities());
+}
+
+// make sure that every element is visited exactly once if the iteration uses a given
+// number of threads
+void testIteration(const GridView& gridView,
+                   unsigned numPartitionThreads,
+                   int numThreads,
+                   bool enableWorkStealing)
+{
+#ifndef _OPENMP
+    (void) numThreads;
+#endif
+
+    ElementChunks chunks;
+    chunks.update(gridView, numPartitionThreads, /*sequenceNumber=*/0);
+    chunks.setEnableWorkStealing(enableWorkStealing);
+
+    std::vector<int> numVisits(static_cast<size_t>(gridView.size(0)), 0);
+    const auto& indexSet = gridView.indexSet();
+
+    Ewoms::ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(chunks);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        auto elemIt = threadedElemIt.beginParallel();
+        for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+            unsigned elemIdx = static_cast<unsigned>(indexSet.index(*elemIt));
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            ++ numVisits[elemIdx];
+        }
+    }
+
+    for (int n : numVisits)
+        REQUIRE(n == 1);
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    std::array<int, dim> cellRes;
+    std::fill(cellRes.begin(), cellRes.end(), 23);
+    Dune::FieldVector<double, dim> upperRight(1.0);
+    Grid grid(upperRight, cellRes);
+    const auto& gridView = grid.leafGridView();
+
+    testPartition(gridView);
+
+    // the parallel regions use fewer, as many and more threads than the partition was
+    // created for
+    for (bool enableWorkStealing : { false, true }) {
+        for (int numThreads : { 1, 2, 4, 8 }) {
+            testIteration(gridView, /*numPartitionThreads=*/4, numThreads, enableWorkStealing);
+        }
+    }
+
+    std::cout << "Entity chunk tests passed\n";
+    return 0;
+}
@@ -0,0 +1,98 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the flat index of the fracture topology.
+ */
+#include "config.h"
+
+#include <ewoms/models/discretefracture/fracturemapper.hh>
+
+#include <cstdlib>
+#include <iostream>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+typedef Ewoms::FractureMapper</*TypeTag=*/void> FractureMapper;
+
+void testEmptyMapper()
+{
+    FractureMapper mapper;
+    REQUIRE(mapper.isFinalized());
+    REQUIRE(!mapper.isFractureVertex(0));
+    REQUIRE(!mapper.isFractureEdge(0, 1));
+}
+
+void testFractureTopology()
+{
+    // a fracture which consists of the edges 1-3 and 3-5 plus a separate one at 7-8.
+    // the grid readers usually add each edge once for every element it belongs to.
+    FractureMapper mapper;
+    mapper.addFractureEdge(3, 1);
+    mapper.addFractureEdge(1, 3);
+    mapper.addFractureEdge(3, 5);
+    mapper.addFractureEdge(8, 7);
+    REQUIRE(!mapper.isFinalized());
+    mapper.finalize();
+    REQUIRE(mapper.isFinalized());
+
+    const unsigned fractureVertices[] = { 1, 3, 5, 7, 8 };
+    for (unsigned vertexIdx : fractureVertices)
+        REQUIRE(mapper.isFractureVertex(vertexIdx));
+    const unsigned otherVertices[] = { 0, 2, 4, 6, 9, 1000 };
+    for (unsigned vertexIdx : otherVertices)
+        REQUIRE(!mapper.isFractureVertex(vertexIdx));
+
+    // edges are undirected
+    REQUIRE(mapper.isFractureEdge(1, 3));
+    REQUIRE(mapper.isFractureEdge(3, 1));
+    REQUIRE(mapper.isFractureEdge(5, 3));
+    REQUIRE(mapper.isFractureEdge(7, 8));
+
+    // both vertices are fracture vertices, but the edge is not a fracture
+    REQUIRE(!mapper.isFractureEdge(1, 5));
+    REQUIRE(!mapper.isFractureEdge(5, 7));
+    REQUIRE(!mapper.isFractureEdge(3, 3));
+    REQUIRE(!mapper.isFractureEdge(3, 1000));
+
+    // adding edges later on requires to finalize the mapper again
+    mapper.addFractureEdge(5, 7);
+    REQUIRE(!mapper.isFinalized());
+    mapper.finalize();
+    REQUIRE(mapper.isFractureEdge(7, 5));
+    REQUIRE(mapper.isFractureEdge(1, 3));
+}
+
+int main()
+{
+    testEmptyMapper();
+    testFractureTopology();
+
+    std::cout << "Fracture mapper tests passed\n";
+    return 0;
+}
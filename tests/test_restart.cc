@@ -0,0 +1,296 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the binary format of the restart files, in particular for the
+ *        detection of corrupted sections and for reading text based restart files.
+ */
+#include "config.h"
+
+#include <ewoms/io/restart.hh>
+#include <ewoms/parallel/tasklets.hh>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+// the restart files only need to know a few properties of the grid view and the
+// simulator, so there is no need to set up an actual simulation
+struct MockCommunication
+{
+    int size() const
+    { return 1; }
+
+    int rank() const
+    { return 0; }
+};
+
+struct MockGridView
+{
+    static const int dimension = 2;
+
+    int size(int codim) const
+    { return codim == 0 ? 16 : (codim == 1 ? 40 : 25); }
+
+    MockCommunication comm() const
+    { return MockCommunication(); }
+};
+
+struct MockProblem
+{
+    std::string name() const
+    { return "test_restart"; }
+};
+
+struct MockSimulator
+{
+    MockGridView gridView() const
+    { return MockGridView(); }
+
+    const MockProblem& problem() const
+    { return problem_; }
+
+    double time() const
+    { return 1.0; }
+
+    MockProblem problem_;
+};
+
+struct Element
+{
+    int index;
+    float value;
+};
+
+template <class Exception>
+void requireThrows(std::function<void()> fn)
+{
+    bool caught = false;
+    try {
+        fn();
+    }
+    catch (const Exception&) {
+        caught = true;
+    }
+    REQUIRE(caught);
+}
+
+void writeRestartFile(const MockSimulator& simulator, Ewoms::TaskletRunner* taskletRunner)
+{
+    std::vector<double> solution(10);
+    for (unsigned i = 0; i < solution.size(); ++i)
+        solution[i] = 1.0/(i + 1);
+    std::vector<Element> elements = { {1, 0.5f}, {2, 1.5f}, {3, 2.5f} };
+
+    Ewoms::Restart res;
+    res.setTaskletRunner(taskletRunner);
+    res.serializeBegin(simulator);
+
+    res.serializeSectionBegin("Header");
+    res.serializeStream() << 42 << " " << 3.5 << "\n";
+    res.serializeSectionEnd();
+
+    res.serializeArray("Elements", elements.data(), elements.size());
+    res.serializeArray("Empty", solution.data(), 0);
+    // the size of the last section is divisible by eight, i.e., the file does not end
+    // with padding bytes
+    res.serializeArray("Solution", solution.data(), solution.size());
+    res.serializeEnd();
+
+    if (taskletRunner)
+        taskletRunner->barrier();
+}
+
+void testRoundTrip(const MockSimulator& simulator, Ewoms::TaskletRunner* taskletRunner)
+{
+    writeRestartFile(simulator, taskletRunner);
+
+    Ewoms::Restart res;
+    res.deserializeBegin(simulator, simulator.time());
+    REQUIRE(!res.isLegacyFormat());
+
+    res.deserializeSectionBegin("Header");
+    int intValue;
+    double scalarValue;
+    res.deserializeStream() >> intValue >> scalarValue;
+    REQUIRE(intValue == 42);
+    REQUIRE(scalarValue == 3.5);
+    res.deserializeSectionEnd();
+
+    std::vector<Element> elements(3);
+    res.deserializeArray("Elements", elements.data(), elements.size());
+    REQUIRE(elements[0].index == 1 && elements[0].value == 0.5f);
+    REQUIRE(elements[2].index == 3 && elements[2].value == 2.5f);
+
+    std::vector<double> solution(10);
+    res.deserializeArray("Empty", solution.data(), 0);
+    res.deserializeArray("Solution", solution.data(), solution.size());
+    for (unsigned i = 0; i < solution.size(); ++i)
+        REQUIRE(solution[i] == 1.0/(i + 1));
+
+    res.deserializeEnd();
+}
+
+void testMismatches(const MockSimulator& simulator)
+{
+    writeRestartFile(simulator, /*taskletRunner=*/nullptr);
+
+    Ewoms::Restart res;
+
+    // unexpected section name
+    res.deserializeBegin(simulator, simulator.time());
+    requireThrows<std::runtime_error>([&res]() { res.deserializeSectionBegin("Wrong"); });
+    res.deserializeEnd();
+
+    // unexpected array size
+    res.deserializeBegin(simulator, simulator.time());
+    res.deserializeSectionBegin("Header");
+    int intValue;
+    double scalarValue;
+    res.deserializeStream() >> intValue >> scalarValue;
+    res.deserializeSectionEnd();
+    std::vector<Element> elements(4);
+    requireThrows<std::runtime_error>([&]() {
+            res.deserializeArray("Elements", elements.data(), elements.size());
+        });
+    res.deserializeEnd();
+
+    // unread data in a text section
+    res.deserializeBegin(simulator, simulator.time());
+    res.deserializeSectionBegin("Header");
+    requireThrows<std::logic_error>([&res]() { res.deserializeSectionEnd(); });
+    res.deserializeEnd();
+}
+
+void testChecksum(const MockSimulator& simulator)
+{
+    writeRestartFile(simulator, /*taskletRunner=*/nullptr);
+
+    Ewoms::Restart res;
+    res.deserializeBegin(simulator, simulator.time());
+    const std::string fileName = res.fileName();
+    res.deserializeEnd();
+
+    // flip a bit of the last value of the solution
+    {
+        std::fstream fs(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekg(-1, std::ios::end);
+        char c;
+        fs.get(c);
+        fs.seekp(-1, std::ios::end);
+        fs.put(static_cast<char>(c ^ 1));
+        REQUIRE(fs.good());
+    }
+
+    // all sections but the corrupted one can still be read
+    res.deserializeBegin(simulator, simulator.time());
+    res.deserializeSectionBegin("Header");
+    int intValue;
+    double scalarValue;
+    res.deserializeStream() >> intValue >> scalarValue;
+    res.deserializeSectionEnd();
+
+    std::vector<Element> elements(3);
+    res.deserializeArray("Elements", elements.data(), elements.size());
+
+    std::vector<double> solution(10);
+    res.deserializeArray("Empty", solution.data(), 0);
+    requireThrows<std::runtime_error>([&]() {
+            res.deserializeArray("Solution", solution.data(), solution.size());
+        });
+    res.deserializeEnd();
+}
+
+void testLegacyFormat(const MockSimulator& simulator)
+{
+    // determine the name of the file and the magic cookie which identifies it
+    writeRestartFile(simulator, /*taskletRunner=*/nullptr);
+    Ewoms::Restart res;
+    res.deserializeBegin(simulator, simulator.time());
+    const std::string fileName = res.fileName();
+    res.deserializeEnd();
+
+    const MockGridView gridView = simulator.gridView();
+    {
+        // the text based format writes each section as a line with its cookie,
+        // followed by the data and a line break
+        std::ofstream os(fileName.c_str());
+        os << "eWoms restart file: gridName='blubb' numCPUs=1 myRank=0 "
+           << "numElements=" << gridView.size(0) << " "
+           << "numEdges=" << gridView.size(1) << " "
+           << "numVertices=" << gridView.size(2) << "\n"
+           << "\n"
+           << "Header\n"
+           << "42 3.5\n";
+    }
+
+    res.deserializeBegin(simulator, simulator.time());
+    REQUIRE(res.isLegacyFormat());
+
+    res.deserializeSectionBegin("Header");
+    int intValue;
+    double scalarValue;
+    res.deserializeStream() >> intValue >> scalarValue;
+    REQUIRE(intValue == 42);
+    REQUIRE(scalarValue == 3.5);
+    res.deserializeSectionEnd();
+
+    // text based files do not contain any arrays
+    std::vector<double> solution(10);
+    requireThrows<std::logic_error>([&]() {
+            res.deserializeArray("Solution", solution.data(), solution.size());
+        });
+    res.deserializeEnd();
+
+    std::remove(fileName.c_str());
+}
+
+int main()
+{
+    MockSimulator simulator;
+
+    testRoundTrip(simulator, /*taskletRunner=*/nullptr);
+
+    // write the file asynchronously
+    Ewoms::TaskletRunner taskletRunner(/*numWorkers=*/1);
+    testRoundTrip(simulator, &taskletRunner);
+
+    testMismatches(simulator);
+    testChecksum(simulator);
+    testLegacyFormat(simulator);
+
+    std::cout << "Restart tests passed\n";
+    return 0;
+}
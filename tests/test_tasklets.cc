@@ -0,0 +1,157 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the tasklet runner, in particular the bounded work queue and the
+ *        propagation of errors.
+ */
+#include "config.h"
+
+#include <ewoms/parallel/tasklets.hh>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#define REQUIRE(cond)                      \
+    {                                      \
+        if (!(cond))                       \
+            std::abort();                  \
+    }
+
+// a tasklet which records how many tasklets run concurrently and optionally fails
+class CountingTasklet : public Ewoms::TaskletInterface
+{
+public:
+    CountingTasklet(std::atomic<int>& numRunning,
+                    std::atomic<int>& maxRunning,
+                    std::atomic<int>& numRuns,
+                    bool fail = false,
+                    int refCount = 1)
+        : Ewoms::TaskletInterface(refCount)
+        , numRunning_(numRunning)
+        , maxRunning_(maxRunning)
+        , numRuns_(numRuns)
+        , fail_(fail)
+    {}
+
+    void run() override
+    {
+        int n = ++ numRunning_;
+        int m = maxRunning_.load();
+        while (n > m && !maxRunning_.compare_exchange_weak(m, n))
+        {}
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ++ numRuns_;
+        -- numRunning_;
+
+        if (fail_)
+            throw std::runtime_error("tasklet failed");
+    }
+
+private:
+    std::atomic<int>& numRunning_;
+    std::atomic<int>& maxRunning_;
+    std::atomic<int>& numRuns_;
+    bool fail_;
+};
+
+template <class Fn>
+bool throwsRuntimeError(Fn fn)
+{
+    try {
+        fn();
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void testSynchronous()
+{
+    std::atomic<int> numRunning(0), maxRunning(0), numRuns(0);
+    Ewoms::TaskletRunner runner(/*numWorkers=*/0);
+
+    // tasklets are run immediately, as often as their reference count says
+    auto future =
+        runner.dispatch(std::make_shared<CountingTasklet>(numRunning, maxRunning, numRuns,
+                                                          /*fail=*/false, /*refCount=*/3));
+    REQUIRE(numRuns == 3);
+    future.get();
+
+    // errors do not escape from dispatch() but are stored in the future and reported
+    // by the next barrier
+    auto failedFuture =
+        runner.dispatch(std::make_shared<CountingTasklet>(numRunning, maxRunning, numRuns,
+                                                          /*fail=*/true));
+    REQUIRE(throwsRuntimeError([&]() { failedFuture.get(); }));
+    REQUIRE(throwsRuntimeError([&]() { runner.barrier(); }));
+    runner.barrier(); // the error is only reported once
+
+    REQUIRE(runner.statistics().numCompleted == 2);
+}
+
+void testAsynchronous()
+{
+    std::atomic<int> numRunning(0), maxRunning(0), numRuns(0);
+    const unsigned maxQueueSize = 2;
+    Ewoms::TaskletRunner runner(/*numWorkers=*/4, maxQueueSize);
+
+    const int numTasklets = 40;
+    for (int i = 0; i < numTasklets; ++i)
+        runner.dispatch(std::make_shared<CountingTasklet>(numRunning, maxRunning, numRuns));
+    runner.barrier();
+
+    REQUIRE(numRuns == numTasklets);
+    REQUIRE(runner.numPending() == 0);
+    REQUIRE(runner.statistics().numCompleted == static_cast<size_t>(numTasklets));
+
+    // the running tasklets count against the limit of the queue
+    REQUIRE(maxRunning <= static_cast<int>(maxQueueSize));
+
+    // the error of a failed tasklet is reported by the barrier and by its future
+    auto failedFuture =
+        runner.dispatch(std::make_shared<CountingTasklet>(numRunning, maxRunning, numRuns,
+                                                          /*fail=*/true));
+    runner.dispatch(std::make_shared<CountingTasklet>(numRunning, maxRunning, numRuns));
+    REQUIRE(throwsRuntimeError([&]() { runner.barrier(); }));
+    REQUIRE(throwsRuntimeError([&]() { failedFuture.get(); }));
+    REQUIRE(numRuns == numTasklets + 2);
+    runner.barrier();
+}
+
+int main()
+{
+    testSynchronous();
+    testAsynchronous();
+
+    std::cout << "Tasklet runner tests passed\n";
+    return 0;
+}